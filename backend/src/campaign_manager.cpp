@@ -0,0 +1,131 @@
+#include "campaign_manager.h"
+
+namespace device_management {
+
+CampaignManager::CampaignManager(DeviceManager* device_manager,
+                                 ActionSimulator* action_simulator)
+    : device_manager_(device_manager), action_simulator_(action_simulator) {
+}
+
+CampaignManager::~CampaignManager() {
+    Shutdown();
+}
+
+void CampaignManager::Shutdown() {
+    stopped_.store(true, std::memory_order_relaxed);
+}
+
+std::string CampaignManager::StartCampaign(DeviceStatus status_filter,
+                                           const std::string& device_type_filter,
+                                           ActionType action_type,
+                                           const std::map<std::string, std::string>& action_params,
+                                           size_t max_concurrency) {
+    // snapshot the targets up front: devices registered after this point
+    // are not part of the campaign, which keeps progress well-defined
+    google::protobuf::RepeatedPtrField<DeviceInfo> targets;
+    device_manager_->QueryDevices(status_filter, device_type_filter, &targets);
+    if (targets.empty()) {
+        return "";
+    }
+
+    auto campaign = std::make_unique<Campaign>();
+    campaign->action_type = action_type;
+    campaign->action_params = action_params;
+    campaign->target_count = static_cast<uint64_t>(targets.size());
+    if (max_concurrency > 0) {
+        campaign->max_concurrency = max_concurrency;
+    }
+
+    // pending is drained from the back, so reverse order keeps dispatch
+    // in the order the query returned
+    campaign->pending.reserve(targets.size());
+    for (int i = targets.size() - 1; i >= 0; --i) {
+        campaign->pending.push_back(targets[i].device_id());
+    }
+
+    std::string campaign_id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        campaign_id = "campaign_" + std::to_string(next_campaign_id_++);
+        campaign->campaign_id = campaign_id;
+        Campaign& entry = *campaign;
+        campaigns_[campaign_id] = std::move(campaign);
+        DispatchLocked(entry);
+    }
+
+    return campaign_id;
+}
+
+void CampaignManager::DispatchLocked(Campaign& campaign) {
+    while (campaign.in_flight < campaign.max_concurrency && !campaign.pending.empty() &&
+           !stopped_.load(std::memory_order_relaxed)) {
+        std::string device_id = std::move(campaign.pending.back());
+        campaign.pending.pop_back();
+
+        std::string campaign_id = campaign.campaign_id;
+        int queue_position = 0;
+        uint64_t action_id = action_simulator_->InitiateAction(
+            device_id,
+            campaign.action_type,
+            campaign.action_params,
+            [this, campaign_id](uint64_t /* action_id */, ActionStatus status) {
+                // only terminal transitions refill the wave; the initial
+                // RUNNING/QUEUED notifications are ignored
+                if (status == ActionStatus::COMPLETED) {
+                    OnActionFinished(campaign_id, true);
+                } else if (status == ActionStatus::FAILED) {
+                    OnActionFinished(campaign_id, false);
+                }
+            },
+            &queue_position);
+
+        if (action_id == 0) {
+            // device queue full: count it failed rather than stalling the wave
+            campaign.failed++;
+            continue;
+        }
+
+        campaign.dispatched++;
+        campaign.in_flight++;
+    }
+}
+
+void CampaignManager::OnActionFinished(const std::string& campaign_id, bool success) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = campaigns_.find(campaign_id);
+    if (it == campaigns_.end()) {
+        return;
+    }
+
+    Campaign& campaign = *it->second;
+    campaign.in_flight--;
+    if (success) {
+        campaign.completed++;
+    } else {
+        campaign.failed++;
+    }
+
+    DispatchLocked(campaign);
+}
+
+bool CampaignManager::GetCampaignStatus(const std::string& campaign_id, CampaignStatus* out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = campaigns_.find(campaign_id);
+    if (it == campaigns_.end()) {
+        return false;
+    }
+
+    const Campaign& campaign = *it->second;
+    out->campaign_id = campaign.campaign_id;
+    out->target_count = campaign.target_count;
+    out->dispatched = campaign.dispatched;
+    out->completed = campaign.completed;
+    out->failed = campaign.failed;
+    out->done = (campaign.completed + campaign.failed >= campaign.target_count);
+
+    return true;
+}
+
+}
@@ -0,0 +1,87 @@
+#ifndef CAMPAIGN_MANAGER_H
+#define CAMPAIGN_MANAGER_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "device_manager.h"
+
+namespace device_management {
+
+// runs fleet-wide action rollouts server-side: a campaign snapshots the
+// devices matching its filters, then keeps at most max_concurrency
+// actions in flight, dispatching the next device from the completion
+// callback of each finished action — so a 100k-device rollout costs one
+// StartCampaign RPC instead of 100k InitiateDeviceAction round trips
+class CampaignManager {
+public:
+    // in-flight actions per campaign when the request leaves it unset
+    static constexpr size_t kDefaultMaxConcurrency = 100;
+
+    CampaignManager(DeviceManager* device_manager, ActionSimulator* action_simulator);
+    ~CampaignManager();
+
+    // aggregate progress of one campaign
+    struct CampaignStatus {
+        std::string campaign_id;
+        uint64_t target_count;
+        uint64_t dispatched;
+        uint64_t completed;
+        uint64_t failed;
+        bool done;
+    };
+
+    // snapshots the matching devices and dispatches the first wave;
+    // returns the campaign id, or an empty string when no device matches
+    std::string StartCampaign(DeviceStatus status_filter,
+                              const std::string& device_type_filter,
+                              ActionType action_type,
+                              const std::map<std::string, std::string>& action_params,
+                              size_t max_concurrency);
+
+    // false when the campaign id is unknown
+    bool GetCampaignStatus(const std::string& campaign_id, CampaignStatus* out);
+
+    // stops dispatching new actions; in-flight ones finish or are
+    // cancelled by the simulator's own shutdown
+    void Shutdown();
+
+private:
+    struct Campaign {
+        std::string campaign_id;
+        ActionType action_type;
+        std::map<std::string, std::string> action_params;
+        std::vector<std::string> pending;  // device ids not yet dispatched
+        uint64_t target_count = 0;
+        uint64_t dispatched = 0;
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        size_t in_flight = 0;
+        size_t max_concurrency = kDefaultMaxConcurrency;
+    };
+
+    // dispatches devices until the concurrency cap is reached; caller
+    // must hold mutex_
+    void DispatchLocked(Campaign& campaign);
+
+    // completion-path hook: accounts the terminal action and refills the
+    // wave with the next pending device
+    void OnActionFinished(const std::string& campaign_id, bool success);
+
+    DeviceManager* device_manager_;
+    ActionSimulator* action_simulator_;
+
+    std::unordered_map<std::string, std::unique_ptr<Campaign>> campaigns_;
+    std::mutex mutex_;
+    uint64_t next_campaign_id_ = 1;
+    std::atomic<bool> stopped_{false};
+};
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include "coarse_clock.h"
+
+#include <mutex>
+#include <thread>
+
+namespace device_management {
+
+std::atomic<int64_t> CoarseClock::now_ns_{0};
+std::atomic<int64_t> CoarseClock::granularity_ms_{CoarseClock::kDefaultGranularityMs};
+
+namespace {
+
+int64_t ReadClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}
+
+void CoarseClock::SetGranularity(std::chrono::milliseconds granularity) {
+    if (granularity.count() > 0) {
+        granularity_ms_.store(granularity.count(), std::memory_order_relaxed);
+    }
+}
+
+void CoarseClock::EnsureTicker() {
+    // the ticker is a process-lifetime facility with no state to tear
+    // down, so it runs detached rather than threading a Stop() through
+    // every owner of a timestamping component
+    static std::once_flag started;
+    std::call_once(started, []() {
+        now_ns_.store(ReadClockNs(), std::memory_order_relaxed);
+        std::thread([]() {
+            for (;;) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(
+                    granularity_ms_.load(std::memory_order_relaxed)));
+                now_ns_.store(ReadClockNs(), std::memory_order_relaxed);
+            }
+        }).detach();
+    });
+}
+
+std::chrono::system_clock::time_point CoarseClock::Now() {
+    EnsureTicker();
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(now_ns_.load(std::memory_order_relaxed))));
+}
+
+}
@@ -0,0 +1,34 @@
+#ifndef COARSE_CLOCK_H
+#define COARSE_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+
+namespace device_management {
+
+// process-wide cached wall clock: a background ticker refreshes one
+// atomic at the configured granularity and readers just load it, so a
+// heartbeat burst costs a relaxed load per timestamp instead of a clock
+// syscall inside the locked region. device timestamps are exposed in
+// whole seconds, so the default 10ms granularity is invisible to clients
+class CoarseClock {
+public:
+    // how often the ticker refreshes the cached value
+    static constexpr int kDefaultGranularityMs = 10;
+
+    // the cached time; starts the ticker on first use
+    static std::chrono::system_clock::time_point Now();
+
+    // adjusts the refresh interval; takes effect on the ticker's next wake
+    static void SetGranularity(std::chrono::milliseconds granularity);
+
+private:
+    static void EnsureTicker();
+
+    static std::atomic<int64_t> now_ns_;
+    static std::atomic<int64_t> granularity_ms_;
+};
+
+}
+
+#endif
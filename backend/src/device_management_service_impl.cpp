@@ -4,12 +4,57 @@
 
 namespace device_management {
 
+// page size applied when a ListDevices request leaves page_size unset,
+// and the hard cap on what a client may ask for in one page
+constexpr size_t kDefaultListPageSize = 1000;
+constexpr size_t kMaxListPageSize = 10000;
+
+// devices copied per lock acquisition when streaming the whole fleet
+constexpr size_t kDefaultStreamChunkSize = 500;
+
+// devices carried per FleetChunk during export; large enough that a
+// 500k-device migration is ~100 messages, small enough to stay well
+// under gRPC's default 4 MB message limit
+constexpr size_t kDefaultMigrationChunkSize = 5000;
+constexpr size_t kMaxMigrationChunkSize = 20000;
+
+// holds one slot of the list-family in-flight count for the enclosing
+// handler; the slot is released on every exit path
+class ListInflightGuard {
+public:
+    explicit ListInflightGuard(std::atomic<size_t>& counter)
+        : counter_(counter) {
+        counter_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~ListInflightGuard() {
+        counter_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<size_t>& counter_;
+};
+
+bool DeviceManagementServiceImpl::DeadlineExpired(grpc::ServerContext* context) {
+    if (context->IsCancelled()) {
+        return true;
+    }
+    // an unset deadline comes back as time_point::max, so the comparison
+    // is safe without a separate "has deadline" check
+    return context->deadline() <= std::chrono::system_clock::now();
+}
+
 DeviceManagementServiceImpl::DeviceManagementServiceImpl() { //Constructor for the service implementation
     device_manager_ = std::make_unique<DeviceManager>();
     action_simulator_ = std::make_unique<ActionSimulator>(device_manager_.get());
+    campaign_manager_ = std::make_unique<CampaignManager>(device_manager_.get(), action_simulator_.get());
+    device_manager_->AttachEventBus(&event_bus_);
 }
 
 DeviceManagementServiceImpl::~DeviceManagementServiceImpl() { //Destructor for the service implementation
+    if (campaign_manager_) {
+        campaign_manager_->Shutdown();
+    }
     if (action_simulator_) {
         action_simulator_->Shutdown();
     }
@@ -19,16 +64,24 @@ grpc::Status DeviceManagementServiceImpl::RegisterDevice(
     grpc::ServerContext* /* context */,
     const RegisterDeviceRequest* request,
     RegisterDeviceResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kRegisterDevice);
     
     const std::string& device_id = request->device_id();
     const std::string& device_name = request->device_name();
     const std::string& device_type = request->device_type();
     
+    // proto3 enums are open: the parser stores any varint, so an
+    // out-of-range status must be rejected here before it can index the
+    // per-status counter array
     DeviceStatus initial_status = request->initial_status();
     if (initial_status == DeviceStatus::DEVICE_STATUS_UNKNOWN) {
         initial_status = DeviceStatus::IDLE;
+    } else if (!DeviceStatus_IsValid(initial_status)) {
+        response->set_success(false);
+        response->set_message("Invalid device status");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid device status");
     }
-    
+
     if (device_id.empty()) {
         response->set_success(false);
         response->set_message("Device ID cannot be empty");
@@ -49,10 +102,80 @@ grpc::Status DeviceManagementServiceImpl::RegisterDevice(
     }
 }
 
+grpc::Status DeviceManagementServiceImpl::RegisterDevices(
+    grpc::ServerContext* context,
+    const RegisterDevicesRequest* request,
+    RegisterDevicesResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kRegisterDevices);
+
+    // batch writes are never shed, but one whose deadline already lapsed
+    // can only waste shard lock time; drop it before any work
+    if (DeadlineExpired(context)) {
+        return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline expired before execution");
+    }
+
+    std::vector<DeviceManager::RegistrationEntry> entries;
+    entries.reserve(request->devices_size());
+
+    for (const auto& device : request->devices()) {
+        DeviceStatus initial_status = device.initial_status();
+        if (initial_status == DeviceStatus::DEVICE_STATUS_UNKNOWN) {
+            initial_status = DeviceStatus::IDLE;
+        }
+        entries.push_back(DeviceManager::RegistrationEntry{
+            device.device_id(), device.device_name(), device.device_type(), initial_status});
+    }
+
+    // entries with an empty id or an out-of-range status (proto3 enums
+    // are open on the wire) are rejected here; the rest go to
+    // DeviceManager as one batch so each shard lock is taken only once
+    std::vector<DeviceManager::RegistrationEntry> valid_entries;
+    valid_entries.reserve(entries.size());
+    for (const auto& entry : entries) {
+        if (!entry.device_id.empty() && DeviceStatus_IsValid(entry.initial_status)) {
+            valid_entries.push_back(entry);
+        }
+    }
+
+    std::vector<bool> results = device_manager_->RegisterDevices(valid_entries);
+
+    bool all_succeeded = true;
+    size_t valid_index = 0;
+    for (const auto& entry : entries) {
+        BatchEntryResult* result = response->add_results();
+        result->set_device_id(entry.device_id);
+
+        if (entry.device_id.empty()) {
+            result->set_success(false);
+            result->set_message("Device ID cannot be empty");
+            all_succeeded = false;
+            continue;
+        }
+        if (!DeviceStatus_IsValid(entry.initial_status)) {
+            result->set_success(false);
+            result->set_message("Invalid device status");
+            all_succeeded = false;
+            continue;
+        }
+
+        bool registered = results[valid_index++];
+        result->set_success(registered);
+        result->set_message(registered ? "Device registered successfully"
+                                       : "Device with ID '" + entry.device_id + "' already exists");
+        all_succeeded = all_succeeded && registered;
+    }
+
+    response->set_success(all_succeeded);
+    response->set_message("Registered " + std::to_string(request->devices_size()) + " device(s)");
+
+    return grpc::Status::OK;
+}
+
 grpc::Status DeviceManagementServiceImpl::SetDeviceStatus(
     grpc::ServerContext* /* context */,
     const SetDeviceStatusRequest* request,
     SetDeviceStatusResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kSetDeviceStatus);
     
     const std::string& device_id = request->device_id();
     DeviceStatus new_status = request->status();
@@ -63,12 +186,14 @@ grpc::Status DeviceManagementServiceImpl::SetDeviceStatus(
         return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Device ID cannot be empty");
     }
     
-    if (new_status == DeviceStatus::DEVICE_STATUS_UNKNOWN) {
+    // DEVICE_STATUS_UNKNOWN carries no meaning, and anything outside the
+    // enum (proto3 enums are open) must never index the counter array
+    if (new_status == DeviceStatus::DEVICE_STATUS_UNKNOWN || !DeviceStatus_IsValid(new_status)) {
         response->set_success(false);
         response->set_message("Invalid device status");
         return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid device status");
     }
-    
+
     DeviceStatus previous_status;
     bool success = device_manager_->SetDeviceStatus(device_id, new_status, &previous_status);
     
@@ -85,10 +210,66 @@ grpc::Status DeviceManagementServiceImpl::SetDeviceStatus(
     }
 }
 
+grpc::Status DeviceManagementServiceImpl::SetDeviceStatusBatch(
+    grpc::ServerContext* context,
+    const SetDeviceStatusBatchRequest* request,
+    SetDeviceStatusBatchResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kSetDeviceStatusBatch);
+
+    if (DeadlineExpired(context)) {
+        return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline expired before execution");
+    }
+
+    std::vector<DeviceManager::StatusUpdateEntry> valid_updates;
+    valid_updates.reserve(request->updates_size());
+
+    for (const auto& update : request->updates()) {
+        if (!update.device_id().empty() && update.status() != DeviceStatus::DEVICE_STATUS_UNKNOWN &&
+            DeviceStatus_IsValid(update.status())) {
+            valid_updates.push_back(DeviceManager::StatusUpdateEntry{update.device_id(), update.status()});
+        }
+    }
+
+    std::vector<bool> results = device_manager_->SetDeviceStatusBatch(valid_updates);
+
+    bool all_succeeded = true;
+    size_t valid_index = 0;
+    for (const auto& update : request->updates()) {
+        BatchEntryResult* result = response->add_results();
+        result->set_device_id(update.device_id());
+
+        if (update.device_id().empty()) {
+            result->set_success(false);
+            result->set_message("Device ID cannot be empty");
+            all_succeeded = false;
+            continue;
+        }
+        if (update.status() == DeviceStatus::DEVICE_STATUS_UNKNOWN ||
+            !DeviceStatus_IsValid(update.status())) {
+            result->set_success(false);
+            result->set_message("Invalid device status");
+            all_succeeded = false;
+            continue;
+        }
+
+        bool updated = results[valid_index++];
+        result->set_success(updated);
+        result->set_message(updated ? "Device status updated successfully"
+                                    : "Device with ID '" + update.device_id() + "' not found");
+        all_succeeded = all_succeeded && updated;
+    }
+
+    response->set_success(all_succeeded);
+    response->set_message("Processed " + std::to_string(request->updates_size()) + " update(s)");
+
+    return grpc::Status::OK;
+}
+
 grpc::Status DeviceManagementServiceImpl::GetDeviceInfo(
     grpc::ServerContext* /* context */,
     const GetDeviceInfoRequest* request,
     GetDeviceInfoResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kGetDeviceInfo);
     
     const std::string& device_id = request->device_id();
     
@@ -98,14 +279,13 @@ grpc::Status DeviceManagementServiceImpl::GetDeviceInfo(
         return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Device ID cannot be empty");
     }
     
-    auto device_info = device_manager_->GetDeviceInfo(device_id);
-    
-    if (device_info) {
+    // filled in place: no intermediate DeviceInfo allocation or deep copy
+    if (device_manager_->GetDeviceInfo(device_id, response->mutable_device_info())) {
         response->set_success(true);
         response->set_message("Device information retrieved successfully");
-        response->mutable_device_info()->CopyFrom(*device_info);
         return grpc::Status::OK;
     } else {
+        response->clear_device_info();
         response->set_success(false);
         response->set_message("Device with ID '" + device_id + "' not found");
         return grpc::Status(grpc::StatusCode::NOT_FOUND, "Device not found");
@@ -116,6 +296,7 @@ grpc::Status DeviceManagementServiceImpl::InitiateDeviceAction(
     grpc::ServerContext* /* context */,
     const InitiateDeviceActionRequest* request,
     InitiateDeviceActionResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kInitiateDeviceAction);
     
     const std::string& device_id = request->device_id();
     ActionType action_type = request->action_type();
@@ -138,32 +319,37 @@ grpc::Status DeviceManagementServiceImpl::InitiateDeviceAction(
         return grpc::Status(grpc::StatusCode::NOT_FOUND, "Device not found");
     }
     
-    auto device_info = device_manager_->GetDeviceInfo(device_id);
-    if (device_info && !device_info->current_action_id().empty()) {
-        response->set_success(false);
-        response->set_message("Device is already busy with action: " + device_info->current_action_id());
-        return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "Device is already busy");
-    }
-    
     std::map<std::string, std::string> action_params;
     for (const auto& param : request->action_params()) {
         action_params[param.first] = param.second;
     }
-    
-    std::string action_id = action_simulator_->InitiateAction(
+
+    // a busy device queues the action instead of failing, so orchestrators
+    // issue one RPC per action rather than busy-retrying
+    int queue_position = 0;
+    uint64_t action_id = action_simulator_->InitiateAction(
         device_id,
         action_type,
         action_params,
-        nullptr
+        nullptr,
+        &queue_position
     );
-    
-    auto action_info = action_simulator_->GetActionStatus(action_id);
-    
-    if (action_info) {
+
+    if (action_id == 0) {
+        response->set_success(false);
+        response->set_message("Device action queue is full");
+        return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Device action queue is full");
+    }
+
+    ActionInfo action_info;
+    if (action_simulator_->GetActionStatus(action_id, &action_info)) {
         response->set_success(true);
-        response->set_message("Action initiated successfully");
-        response->set_action_id(action_id);
-        response->set_action_status(action_info->status());
+        response->set_message(queue_position > 0
+            ? "Action queued at position " + std::to_string(queue_position)
+            : "Action initiated successfully");
+        response->set_action_id(ActionSimulator::FormatActionId(action_id));
+        response->set_action_status(action_info.status());
+        response->set_queue_position(queue_position);
         return grpc::Status::OK;
     } else {
         response->set_success(false);
@@ -172,48 +358,819 @@ grpc::Status DeviceManagementServiceImpl::InitiateDeviceAction(
     }
 }
 
+grpc::Status DeviceManagementServiceImpl::InitiateDeviceActionBatch(
+    grpc::ServerContext* context,
+    const InitiateDeviceActionBatchRequest* request,
+    InitiateDeviceActionBatchResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kInitiateDeviceActionBatch);
+
+    if (DeadlineExpired(context)) {
+        return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline expired before execution");
+    }
+
+    bool all_succeeded = true;
+
+    for (const auto& action_request : request->actions()) {
+        InitiateDeviceActionBatchEntryResult* result = response->add_results();
+        result->set_device_id(action_request.device_id());
+
+        if (action_request.device_id().empty()) {
+            result->set_success(false);
+            result->set_message("Device ID cannot be empty");
+            all_succeeded = false;
+            continue;
+        }
+        if (action_request.action_type() == ActionType::ACTION_TYPE_UNKNOWN) {
+            result->set_success(false);
+            result->set_message("Invalid action type");
+            all_succeeded = false;
+            continue;
+        }
+
+        if (!device_manager_->DeviceExists(action_request.device_id())) {
+            result->set_success(false);
+            result->set_message("Device with ID '" + action_request.device_id() + "' not found");
+            all_succeeded = false;
+            continue;
+        }
+
+        std::map<std::string, std::string> action_params;
+        for (const auto& param : action_request.action_params()) {
+            action_params[param.first] = param.second;
+        }
+
+        int queue_position = 0;
+        uint64_t action_id = action_simulator_->InitiateAction(
+            action_request.device_id(),
+            action_request.action_type(),
+            action_params,
+            nullptr,
+            &queue_position
+        );
+
+        if (action_id == 0) {
+            result->set_success(false);
+            result->set_message("Device action queue is full");
+            all_succeeded = false;
+            continue;
+        }
+
+        result->set_success(true);
+        result->set_message(queue_position > 0
+            ? "Action queued at position " + std::to_string(queue_position)
+            : "Action initiated successfully");
+        result->set_action_id(ActionSimulator::FormatActionId(action_id));
+        result->set_queue_position(queue_position);
+    }
+
+    response->set_success(all_succeeded);
+    response->set_message("Processed " + std::to_string(request->actions_size()) + " action(s)");
+
+    return grpc::Status::OK;
+}
+
 grpc::Status DeviceManagementServiceImpl::GetDeviceActionStatus(
     grpc::ServerContext* /* context */,
     const GetDeviceActionStatusRequest* request,
     GetDeviceActionStatusResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kGetDeviceActionStatus);
     
     const std::string& action_id = request->action_id();
-    
+
     if (action_id.empty()) {
         response->set_success(false);
         response->set_message("Action ID cannot be empty");
         return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Action ID cannot be empty");
     }
-    
-    auto action_info = action_simulator_->GetActionStatus(action_id);
-    
-    if (action_info) {
+
+    // the wire form is parsed back into the packed id here, so the lookup
+    // below hashes an integer instead of the full string
+    uint64_t packed_id = 0;
+    if (!ActionSimulator::ParseActionId(action_id, &packed_id)) {
+        response->set_success(false);
+        response->set_message("Action with ID '" + action_id + "' not found");
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Action not found");
+    }
+
+    // filled in place: no intermediate ActionInfo allocation or deep copy
+    if (action_simulator_->GetActionStatus(packed_id, response->mutable_action_info())) {
         response->set_success(true);
         response->set_message("Action status retrieved successfully");
-        response->mutable_action_info()->CopyFrom(*action_info);
         return grpc::Status::OK;
     } else {
+        response->clear_action_info();
         response->set_success(false);
         response->set_message("Action with ID '" + action_id + "' not found");
         return grpc::Status(grpc::StatusCode::NOT_FOUND, "Action not found");
     }
 }
 
-grpc::Status DeviceManagementServiceImpl::ListDevices(
+grpc::Status DeviceManagementServiceImpl::CancelDeviceAction(
+    grpc::ServerContext* /* context */,
+    const CancelDeviceActionRequest* request,
+    CancelDeviceActionResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kCancelDeviceAction);
+
+    const std::string& action_id = request->action_id();
+
+    if (action_id.empty()) {
+        response->set_success(false);
+        response->set_message("Action ID cannot be empty");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Action ID cannot be empty");
+    }
+
+    uint64_t packed_id = 0;
+    if (!ActionSimulator::ParseActionId(action_id, &packed_id)) {
+        response->set_success(false);
+        response->set_message("Action with ID '" + action_id + "' not found");
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Action not found");
+    }
+
+    switch (action_simulator_->CancelAction(packed_id)) {
+        case ActionSimulator::CancelResult::kNotFound: {
+            std::string message = "Action with ID '" + action_id + "' not found";
+            response->set_success(false);
+            response->set_message(message);
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, message);
+        }
+        case ActionSimulator::CancelResult::kAlreadyFinished: {
+            std::string message = "Action has already finished";
+            response->set_success(false);
+            response->set_message(message);
+            return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, message);
+        }
+        case ActionSimulator::CancelResult::kCancelled:
+            break;
+    }
+
+    response->set_success(true);
+    response->set_message("Action cancellation requested");
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::GetDeviceActionHistory(
     grpc::ServerContext* /* context */,
-    const ListDevicesRequest* /* request */,
+    const GetDeviceActionHistoryRequest* request,
+    GetDeviceActionHistoryResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kGetDeviceActionHistory);
+
+    const std::string& device_id = request->device_id();
+
+    if (device_id.empty()) {
+        response->set_success(false);
+        response->set_message("Device ID cannot be empty");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Device ID cannot be empty");
+    }
+
+    if (request->limit() < 0) {
+        response->set_success(false);
+        response->set_message("Limit cannot be negative");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Limit cannot be negative");
+    }
+
+    // a device with no ledger entries is only an error when it does not
+    // exist at all; a known device that never ran anything gets an empty
+    // (successful) history
+    if (!action_simulator_->GetDeviceActionHistory(device_id,
+                                                   request->start_time(),
+                                                   request->end_time(),
+                                                   static_cast<size_t>(request->limit()),
+                                                   response->mutable_records()) &&
+        !device_manager_->DeviceExists(device_id)) {
+        response->set_success(false);
+        response->set_message("Device with ID '" + device_id + "' not found");
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Device not found");
+    }
+
+    response->set_success(true);
+    response->set_message("Retrieved " + std::to_string(response->records_size()) + " record(s)");
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::ListDevices(
+    grpc::ServerContext* context,
+    const ListDevicesRequest* request,
     ListDevicesResponse* response) {
-    
-    std::vector<DeviceInfo> devices = device_manager_->ListAllDevices();
-    
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kListDevices);
+
+    // a request whose deadline already passed would do a full page of
+    // work only to have the reply discarded; drop it before any locks
+    if (DeadlineExpired(context)) {
+        return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline expired before execution");
+    }
+
+    // listings are the sheddable tier: past the in-flight limit they are
+    // rejected immediately so writes keep landing during an overload
+    ListInflightGuard inflight(list_inflight_);
+    size_t limit = list_inflight_limit_.load(std::memory_order_relaxed);
+    if (limit != 0 && list_inflight_.load(std::memory_order_relaxed) > limit) {
+        response->set_success(false);
+        response->set_message("Server overloaded, retry later");
+        return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Server overloaded, retry later");
+    }
+
+    size_t page_size = kDefaultListPageSize;
+    if (request->page_size() > 0) {
+        page_size = std::min(static_cast<size_t>(request->page_size()), kMaxListPageSize);
+    }
+
+    // page tokens are the decimal offset of the first device on the page
+    uint64_t page_offset = 0;
+    if (!request->page_token().empty()) {
+        try {
+            page_offset = std::stoull(request->page_token());
+        } catch (const std::exception&) {
+            response->set_success(false);
+            response->set_message("Invalid page token");
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid page token");
+        }
+    }
+
+    // the page is appended straight into the response's repeated field,
+    // so a 10k-device reply costs no intermediate messages or copies
+    bool has_more = false;
+    device_manager_->ListDevices(
+        request->status_filter(),
+        request->device_type_filter(),
+        page_size,
+        page_offset,
+        &has_more,
+        response->mutable_devices());
+
+    // re-check after the shard walk: if the deadline lapsed while we held
+    // the locks, skip serializing a reply nobody will read
+    if (DeadlineExpired(context)) {
+        return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline expired during execution");
+    }
+
     response->set_success(true);
-    response->set_message("Retrieved " + std::to_string(devices.size()) + " device(s)");
-    
-    for (const auto& device : devices) {
-        DeviceInfo* device_info = response->add_devices();
-        device_info->CopyFrom(device);
+    response->set_message("Retrieved " + std::to_string(response->devices_size()) + " device(s)");
+
+    if (has_more) {
+        response->set_next_page_token(std::to_string(page_offset + response->devices_size()));
     }
-    
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::QueryDevices(
+    grpc::ServerContext* context,
+    const QueryDevicesRequest* request,
+    QueryDevicesResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kQueryDevices);
+
+    if (DeadlineExpired(context)) {
+        return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline expired before execution");
+    }
+
+    ListInflightGuard inflight(list_inflight_);
+    size_t limit = list_inflight_limit_.load(std::memory_order_relaxed);
+    if (limit != 0 && list_inflight_.load(std::memory_order_relaxed) > limit) {
+        response->set_success(false);
+        response->set_message("Server overloaded, retry later");
+        return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Server overloaded, retry later");
+    }
+
+    // an unfiltered query would copy the whole fleet; that's what the
+    // paged ListDevices and StreamDevices RPCs are for
+    if (request->status_filter() == DeviceStatus::DEVICE_STATUS_UNKNOWN &&
+        request->device_type_filter().empty()) {
+        response->set_success(false);
+        response->set_message("At least one filter must be set; use ListDevices for the full fleet");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                            "At least one filter must be set");
+    }
+
+    device_manager_->QueryDevices(
+        request->status_filter(),
+        request->device_type_filter(),
+        response->mutable_devices());
+
+    if (DeadlineExpired(context)) {
+        return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline expired during execution");
+    }
+
+    response->set_success(true);
+    response->set_message("Matched " + std::to_string(response->devices_size()) + " device(s)");
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::StreamDevices(
+    grpc::ServerContext* context,
+    const StreamDevicesRequest* request,
+    grpc::ServerWriter<DeviceInfo>* writer) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kStreamDevices);
+
+    size_t chunk_size = kDefaultStreamChunkSize;
+    if (request->chunk_size() > 0) {
+        chunk_size = std::min(static_cast<size_t>(request->chunk_size()), kMaxListPageSize);
+    }
+
+    // devices are written to the stream as each chunk is copied out, so
+    // memory stays bounded by one chunk regardless of fleet size
+    device_manager_->StreamDevices(chunk_size, [&](std::vector<DeviceInfo>& chunk) {
+        for (auto& device_info : chunk) {
+            if (context->IsCancelled() || !writer->Write(device_info)) {
+                return false;
+            }
+        }
+        return true;
+    });
+
+    if (context->IsCancelled()) {
+        return grpc::Status(grpc::StatusCode::CANCELLED, "Stream cancelled by client");
+    }
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::WatchDevices(
+    grpc::ServerContext* context,
+    const WatchDevicesRequest* request,
+    grpc::ServerWriter<DeviceInfo>* writer) {
+    // the recorded "latency" is the stream's lifetime; the call count is
+    // what makes watchers visible in GetServerStats
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kWatchDevices);
+
+    // each stream parks one sync handler thread until the client goes
+    // away, so unbounded watchers would drain the bounded pool and stall
+    // every RPC including writes; past the cap new streams are shed the
+    // same way the list tier is
+    ListInflightGuard inflight(watch_inflight_);
+    size_t limit = watch_inflight_limit_.load(std::memory_order_relaxed);
+    if (limit != 0 && watch_inflight_.load(std::memory_order_relaxed) > limit) {
+        return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                            "Too many concurrent watch streams, retry later");
+    }
+
+    auto subscription = event_bus_.Subscribe();
+
+    const DeviceStatus status_filter = request->status_filter();
+    const std::string& type_filter = request->device_type_filter();
+
+    // wake periodically so client disconnects are noticed even when the
+    // fleet is quiet
+    DeviceInfo event;
+    while (!context->IsCancelled()) {
+        if (!subscription->Next(&event, std::chrono::milliseconds(250))) {
+            continue;
+        }
+
+        if (status_filter != DeviceStatus::DEVICE_STATUS_UNKNOWN && event.status() != status_filter) {
+            continue;
+        }
+        if (!type_filter.empty() && event.device_type() != type_filter) {
+            continue;
+        }
+
+        if (!writer->Write(event)) {
+            break;
+        }
+    }
+
+    event_bus_.Unsubscribe(subscription);
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::GetServerStats(
+    grpc::ServerContext* /* context */,
+    const GetServerStatsRequest* /* request */,
+    GetServerStatsResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kGetServerStats);
+
+    for (const auto& snapshot : metrics_.Snapshot()) {
+        RpcStats* rpc_stats = response->add_rpc_stats();
+        rpc_stats->set_rpc_name(snapshot.name);
+        rpc_stats->set_call_count(snapshot.count);
+        rpc_stats->set_total_latency_usec(snapshot.total_usec);
+        for (uint64_t bucket : snapshot.buckets) {
+            rpc_stats->add_latency_bucket_counts(bucket);
+        }
+    }
+
+    response->set_device_count(device_manager_->DeviceCount());
+    response->set_live_action_count(action_simulator_->LiveActionCount());
+    response->set_total_action_count(action_simulator_->TotalActionCount());
+    response->set_uptime_seconds(metrics_.UptimeSeconds());
+
+    response->set_success(true);
+    response->set_message("Server statistics retrieved successfully");
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::GetFleetStats(
+    grpc::ServerContext* /* context */,
+    const GetFleetStatsRequest* /* request */,
+    GetFleetStatsResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kGetFleetStats);
+
+    // everything here reads counters the mutators maintain incrementally,
+    // so the dashboard refresh never touches per-device state
+    std::array<uint64_t, 8> status_counts = device_manager_->StatusCounts();
+    for (size_t i = 0; i < status_counts.size(); ++i) {
+        if (status_counts[i] == 0) {
+            continue;
+        }
+        DeviceStatusCount* entry = response->add_status_counts();
+        entry->set_status(static_cast<DeviceStatus>(i));
+        entry->set_count(status_counts[i]);
+    }
+
+    for (const auto& pair : device_manager_->TypeCounts()) {
+        DeviceTypeCount* entry = response->add_type_counts();
+        entry->set_device_type(pair.first);
+        entry->set_count(pair.second);
+    }
+
+    uint64_t completed = 0;
+    uint64_t failed = 0;
+    action_simulator_->CompletionCountsLastHour(&completed, &failed);
+
+    response->set_device_count(device_manager_->DeviceCount());
+    response->set_actions_running(action_simulator_->LiveActionCount());
+    response->set_actions_completed_last_hour(completed);
+    response->set_actions_failed_last_hour(failed);
+
+    response->set_success(true);
+    response->set_message("Fleet statistics retrieved successfully");
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::StartCampaign(
+    grpc::ServerContext* /* context */,
+    const StartCampaignRequest* request,
+    StartCampaignResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kStartCampaign);
+
+    if (request->status_filter() == DeviceStatus::DEVICE_STATUS_UNKNOWN &&
+        request->device_type_filter().empty()) {
+        response->set_success(false);
+        response->set_message("At least one of status_filter or device_type_filter must be set");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                            "At least one of status_filter or device_type_filter must be set");
+    }
+
+    if (request->action_type() == ActionType::ACTION_TYPE_UNKNOWN) {
+        response->set_success(false);
+        response->set_message("Action type must be specified");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Action type must be specified");
+    }
+
+    if (request->max_concurrency() < 0) {
+        response->set_success(false);
+        response->set_message("max_concurrency cannot be negative");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "max_concurrency cannot be negative");
+    }
+
+    std::map<std::string, std::string> action_params;
+    for (const auto& param : request->action_params()) {
+        action_params[param.first] = param.second;
+    }
+
+    std::string campaign_id = campaign_manager_->StartCampaign(
+        request->status_filter(),
+        request->device_type_filter(),
+        request->action_type(),
+        action_params,
+        static_cast<size_t>(request->max_concurrency()));
+
+    if (campaign_id.empty()) {
+        response->set_success(false);
+        response->set_message("No devices match the campaign filters");
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "No devices match the campaign filters");
+    }
+
+    CampaignManager::CampaignStatus status;
+    campaign_manager_->GetCampaignStatus(campaign_id, &status);
+
+    response->set_success(true);
+    response->set_message("Campaign started with " + std::to_string(status.target_count) + " target device(s)");
+    response->set_campaign_id(campaign_id);
+    response->set_target_count(status.target_count);
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::GetCampaignStatus(
+    grpc::ServerContext* /* context */,
+    const GetCampaignStatusRequest* request,
+    GetCampaignStatusResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kGetCampaignStatus);
+
+    CampaignManager::CampaignStatus status;
+    if (!campaign_manager_->GetCampaignStatus(request->campaign_id(), &status)) {
+        response->set_success(false);
+        response->set_message("Campaign not found: " + request->campaign_id());
+        return grpc::Status(grpc::StatusCode::NOT_FOUND,
+                            "Campaign not found: " + request->campaign_id());
+    }
+
+    response->set_success(true);
+    response->set_message("Campaign status retrieved successfully");
+    response->set_campaign_id(status.campaign_id);
+    response->set_target_count(status.target_count);
+    response->set_dispatched(status.dispatched);
+    response->set_completed(status.completed);
+    response->set_failed(status.failed);
+    response->set_done(status.done);
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::ExportFleet(
+    grpc::ServerContext* context,
+    const ExportFleetRequest* request,
+    grpc::ServerWriter<FleetChunk>* writer) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kExportFleet);
+
+    size_t chunk_size = kDefaultMigrationChunkSize;
+    if (request->chunk_size() > 0) {
+        chunk_size = std::min(static_cast<size_t>(request->chunk_size()), kMaxMigrationChunkSize);
+    }
+
+    // each FleetChunk carries thousands of records, so the whole fleet
+    // moves in a handful of large writes instead of per-device RPCs
+    device_manager_->ExportDevicesChunked(chunk_size, [&](std::vector<DeviceManager::DeviceRecord>& records) {
+        FleetChunk chunk;
+        chunk.mutable_devices()->Reserve(static_cast<int>(records.size()));
+        for (const auto& record : records) {
+            FleetDeviceRecord* out = chunk.add_devices();
+            out->set_device_id(record.device_id);
+            out->set_device_name(record.device_name);
+            out->set_device_type(record.device_type);
+            out->set_status(record.status);
+            out->set_registered_at(record.registered_at);
+            out->set_last_updated(record.last_updated);
+        }
+        return !context->IsCancelled() && writer->Write(chunk);
+    });
+
+    if (context->IsCancelled()) {
+        return grpc::Status(grpc::StatusCode::CANCELLED, "Export cancelled by client");
+    }
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::ImportFleet(
+    grpc::ServerContext* /* context */,
+    grpc::ServerReader<FleetChunk>* reader,
+    ImportFleetResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kImportFleet);
+
+    uint64_t imported = 0;
+    uint64_t skipped = 0;
+
+    // each chunk is inserted as one batch, so the shard locks are taken
+    // once per chunk rather than once per device
+    FleetChunk chunk;
+    std::vector<DeviceManager::DeviceRecord> records;
+    while (reader->Read(&chunk)) {
+        records.clear();
+        records.reserve(chunk.devices_size());
+
+        for (const auto& in : chunk.devices()) {
+            // proto3 enums are open: a hostile or corrupt stream can carry
+            // any varint as the status, which must never reach the
+            // per-status counter array
+            if (in.device_id().empty() || !DeviceStatus_IsValid(in.status())) {
+                skipped++;
+                continue;
+            }
+            DeviceManager::DeviceRecord record;
+            record.device_id = in.device_id();
+            record.device_name = in.device_name();
+            record.device_type = in.device_type();
+            record.status = in.status();
+            record.registered_at = in.registered_at();
+            record.last_updated = in.last_updated();
+            records.push_back(std::move(record));
+        }
+
+        size_t inserted = device_manager_->RestoreDevices(records);
+        imported += inserted;
+        skipped += records.size() - inserted;
+    }
+
+    response->set_success(true);
+    response->set_message("Imported " + std::to_string(imported) + " device(s), skipped " +
+                          std::to_string(skipped));
+    response->set_imported_count(imported);
+    response->set_skipped_count(skipped);
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::CreateDeviceGroup(
+    grpc::ServerContext* /* context */,
+    const CreateDeviceGroupRequest* request,
+    CreateDeviceGroupResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kCreateDeviceGroup);
+
+    if (request->group_id().empty()) {
+        response->set_success(false);
+        response->set_message("Group ID cannot be empty");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Group ID cannot be empty");
+    }
+
+    switch (device_manager_->CreateGroup(request->group_id(), request->parent_group_id())) {
+        case DeviceManager::CreateGroupResult::kAlreadyExists: {
+            std::string message = "Group with ID '" + request->group_id() + "' already exists";
+            response->set_success(false);
+            response->set_message(message);
+            return grpc::Status(grpc::StatusCode::ALREADY_EXISTS, message);
+        }
+        case DeviceManager::CreateGroupResult::kParentNotFound: {
+            std::string message =
+                "Parent group with ID '" + request->parent_group_id() + "' not found";
+            response->set_success(false);
+            response->set_message(message);
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, message);
+        }
+        case DeviceManager::CreateGroupResult::kCreated:
+            break;
+    }
+
+    response->set_success(true);
+    response->set_message("Group created successfully");
+    response->set_group_id(request->group_id());
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::AssignDeviceToGroup(
+    grpc::ServerContext* /* context */,
+    const AssignDeviceToGroupRequest* request,
+    AssignDeviceToGroupResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kAssignDeviceToGroup);
+
+    if (request->device_id().empty() || request->group_id().empty()) {
+        response->set_success(false);
+        response->set_message("Device ID and group ID cannot be empty");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                            "Device ID and group ID cannot be empty");
+    }
+
+    std::string error;
+    if (!device_manager_->AssignDeviceToGroup(request->device_id(), request->group_id(), &error)) {
+        response->set_success(false);
+        response->set_message(error);
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, error);
+    }
+
+    response->set_success(true);
+    response->set_message("Device assigned to group successfully");
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::SetGroupStatus(
+    grpc::ServerContext* /* context */,
+    const SetGroupStatusRequest* request,
+    SetGroupStatusResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kSetGroupStatus);
+
+    if (request->group_id().empty()) {
+        response->set_success(false);
+        response->set_message("Group ID cannot be empty");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Group ID cannot be empty");
+    }
+
+    if (request->status() == DeviceStatus::DEVICE_STATUS_UNKNOWN ||
+        !DeviceStatus_IsValid(request->status())) {
+        response->set_success(false);
+        response->set_message("Invalid device status");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid device status");
+    }
+
+    size_t updated = 0;
+    if (!device_manager_->SetGroupStatus(request->group_id(), request->status(), &updated)) {
+        response->set_success(false);
+        response->set_message("Group with ID '" + request->group_id() + "' not found");
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Group not found");
+    }
+
+    response->set_success(true);
+    response->set_message("Updated " + std::to_string(updated) + " device(s)");
+    response->set_updated_count(updated);
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::ListGroupDevices(
+    grpc::ServerContext* context,
+    const ListGroupDevicesRequest* request,
+    ListGroupDevicesResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kListGroupDevices);
+
+    if (DeadlineExpired(context)) {
+        return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline expired before execution");
+    }
+
+    ListInflightGuard inflight(list_inflight_);
+    size_t limit = list_inflight_limit_.load(std::memory_order_relaxed);
+    if (limit != 0 && list_inflight_.load(std::memory_order_relaxed) > limit) {
+        response->set_success(false);
+        response->set_message("Server overloaded, retry later");
+        return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Server overloaded, retry later");
+    }
+
+    if (request->group_id().empty()) {
+        response->set_success(false);
+        response->set_message("Group ID cannot be empty");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Group ID cannot be empty");
+    }
+
+    size_t page_size = kDefaultListPageSize;
+    if (request->page_size() > 0) {
+        page_size = std::min(static_cast<size_t>(request->page_size()), kMaxListPageSize);
+    }
+
+    // same decimal-offset page tokens as ListDevices
+    uint64_t page_offset = 0;
+    if (!request->page_token().empty()) {
+        try {
+            page_offset = std::stoull(request->page_token());
+        } catch (const std::exception&) {
+            response->set_success(false);
+            response->set_message("Invalid page token");
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid page token");
+        }
+    }
+
+    bool has_more = false;
+    if (!device_manager_->ListGroupDevices(request->group_id(), page_size, page_offset,
+                                           &has_more, response->mutable_devices())) {
+        response->set_success(false);
+        response->set_message("Group with ID '" + request->group_id() + "' not found");
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Group not found");
+    }
+
+    response->set_success(true);
+    response->set_message("Retrieved " + std::to_string(response->devices_size()) + " device(s)");
+
+    if (has_more) {
+        response->set_next_page_token(std::to_string(page_offset + response->devices_size()));
+    }
+
+    return grpc::Status::OK;
+}
+
+grpc::Status DeviceManagementServiceImpl::InitiateGroupAction(
+    grpc::ServerContext* /* context */,
+    const InitiateGroupActionRequest* request,
+    InitiateGroupActionResponse* response) {
+    ScopedRpcTimer timer(metrics_, ServerMetrics::kInitiateGroupAction);
+
+    if (request->group_id().empty()) {
+        response->set_success(false);
+        response->set_message("Group ID cannot be empty");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Group ID cannot be empty");
+    }
+
+    if (request->action_type() == ActionType::ACTION_TYPE_UNKNOWN) {
+        response->set_success(false);
+        response->set_message("Invalid action type");
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid action type");
+    }
+
+    std::vector<std::string> device_ids;
+    if (!device_manager_->GroupDeviceIds(request->group_id(), &device_ids)) {
+        response->set_success(false);
+        response->set_message("Group with ID '" + request->group_id() + "' not found");
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Group not found");
+    }
+
+    std::map<std::string, std::string> action_params;
+    for (const auto& param : request->action_params()) {
+        action_params[param.first] = param.second;
+    }
+
+    // the per-device queueing means every member either starts or waits
+    // its turn; only a full queue counts as a failure
+    uint64_t initiated = 0;
+    uint64_t failed = 0;
+    for (const auto& device_id : device_ids) {
+        uint64_t action_id = action_simulator_->InitiateAction(
+            device_id, request->action_type(), action_params, nullptr);
+        if (action_id == 0) {
+            failed++;
+        } else {
+            initiated++;
+        }
+    }
+
+    response->set_success(failed == 0);
+    response->set_message("Initiated " + std::to_string(initiated) + " action(s), " +
+                          std::to_string(failed) + " failed");
+    response->set_initiated_count(initiated);
+    response->set_failed_count(failed);
+
     return grpc::Status::OK;
 }
 
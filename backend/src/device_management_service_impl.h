@@ -1,8 +1,12 @@
 #ifndef DEVICE_MANAGEMENT_SERVICE_IMPL_H
 #define DEVICE_MANAGEMENT_SERVICE_IMPL_H
 
+#include "campaign_manager.h"
 #include "device_management.grpc.pb.h"
 #include "device_manager.h"
+#include "event_bus.h"
+#include "metrics.h"
+#include <atomic>
 #include <memory>
 
 namespace device_management{
@@ -16,10 +20,18 @@ namespace device_management{
             const RegisterDeviceRequest* request,
             RegisterDeviceResponse* response) override;
 
+        grpc::Status RegisterDevices(grpc::ServerContext* context,
+            const RegisterDevicesRequest* request,
+            RegisterDevicesResponse* response) override;
+
         grpc::Status SetDeviceStatus(grpc::ServerContext* context,
                     const SetDeviceStatusRequest* request,
                     SetDeviceStatusResponse* response) override;
 
+        grpc::Status SetDeviceStatusBatch(grpc::ServerContext* context,
+                    const SetDeviceStatusBatchRequest* request,
+                    SetDeviceStatusBatchResponse* response) override;
+
         grpc::Status GetDeviceInfo(grpc::ServerContext* context,
                 const GetDeviceInfoRequest* request,
                 GetDeviceInfoResponse* response) override;
@@ -28,17 +40,125 @@ namespace device_management{
                         const InitiateDeviceActionRequest* request,
                         InitiateDeviceActionResponse* response) override;
 
+        grpc::Status InitiateDeviceActionBatch(grpc::ServerContext* context,
+                        const InitiateDeviceActionBatchRequest* request,
+                        InitiateDeviceActionBatchResponse* response) override;
+
         grpc::Status GetDeviceActionStatus(grpc::ServerContext* context,
                         const GetDeviceActionStatusRequest* request,
                         GetDeviceActionStatusResponse* response) override;
 
+        grpc::Status CancelDeviceAction(grpc::ServerContext* context,
+                const CancelDeviceActionRequest* request,
+                CancelDeviceActionResponse* response) override;
+
+        grpc::Status GetDeviceActionHistory(grpc::ServerContext* context,
+                const GetDeviceActionHistoryRequest* request,
+                GetDeviceActionHistoryResponse* response) override;
+
         grpc::Status ListDevices(grpc::ServerContext* context,
                 const ListDevicesRequest* request,
                 ListDevicesResponse* response) override;
 
+        grpc::Status QueryDevices(grpc::ServerContext* context,
+                const QueryDevicesRequest* request,
+                QueryDevicesResponse* response) override;
+
+        grpc::Status StreamDevices(grpc::ServerContext* context,
+                const StreamDevicesRequest* request,
+                grpc::ServerWriter<DeviceInfo>* writer) override;
+
+        grpc::Status WatchDevices(grpc::ServerContext* context,
+                const WatchDevicesRequest* request,
+                grpc::ServerWriter<DeviceInfo>* writer) override;
+
+        grpc::Status GetServerStats(grpc::ServerContext* context,
+                const GetServerStatsRequest* request,
+                GetServerStatsResponse* response) override;
+
+        grpc::Status GetFleetStats(grpc::ServerContext* context,
+                const GetFleetStatsRequest* request,
+                GetFleetStatsResponse* response) override;
+
+        grpc::Status StartCampaign(grpc::ServerContext* context,
+                const StartCampaignRequest* request,
+                StartCampaignResponse* response) override;
+
+        grpc::Status GetCampaignStatus(grpc::ServerContext* context,
+                const GetCampaignStatusRequest* request,
+                GetCampaignStatusResponse* response) override;
+
+        grpc::Status ExportFleet(grpc::ServerContext* context,
+                const ExportFleetRequest* request,
+                grpc::ServerWriter<FleetChunk>* writer) override;
+
+        grpc::Status ImportFleet(grpc::ServerContext* context,
+                grpc::ServerReader<FleetChunk>* reader,
+                ImportFleetResponse* response) override;
+
+        grpc::Status CreateDeviceGroup(grpc::ServerContext* context,
+                const CreateDeviceGroupRequest* request,
+                CreateDeviceGroupResponse* response) override;
+
+        grpc::Status AssignDeviceToGroup(grpc::ServerContext* context,
+                const AssignDeviceToGroupRequest* request,
+                AssignDeviceToGroupResponse* response) override;
+
+        grpc::Status SetGroupStatus(grpc::ServerContext* context,
+                const SetGroupStatusRequest* request,
+                SetGroupStatusResponse* response) override;
+
+        grpc::Status ListGroupDevices(grpc::ServerContext* context,
+                const ListGroupDevicesRequest* request,
+                ListGroupDevicesResponse* response) override;
+
+        grpc::Status InitiateGroupAction(grpc::ServerContext* context,
+                const InitiateGroupActionRequest* request,
+                InitiateGroupActionResponse* response) override;
+
+        // list-family RPCs in flight before further ones are shed
+        static constexpr size_t kDefaultListInflightLimit = 64;
+
+        // concurrent WatchDevices streams before new ones are rejected;
+        // each stream pins a sync handler thread for its whole lifetime,
+        // so this must stay well under the handler pool size
+        static constexpr size_t kDefaultWatchInflightLimit = 8;
+
+        // exposed so server.cpp can print periodic stats dumps
+        const ServerMetrics& metrics() const { return metrics_; }
+
+        // caps concurrent list-family RPCs (ListDevices, QueryDevices,
+        // ListGroupDevices); 0 disables shedding. writes are never shed
+        void SetListInflightLimit(size_t limit) { list_inflight_limit_ = limit; }
+
+        // caps concurrent WatchDevices streams; 0 disables the cap.
+        // server.cpp sizes this from the handler pool so parked watcher
+        // threads can never starve the unary RPCs
+        void SetWatchInflightLimit(size_t limit) { watch_inflight_limit_ = limit; }
+
+        // exposed so server.cpp can wire snapshot load/save around startup
+        DeviceManager* device_manager() { return device_manager_.get(); }
+
     private:
+    // true when the client's deadline has already passed or the call was
+    // cancelled; such work is dropped instead of executed
+    static bool DeadlineExpired(grpc::ServerContext* context);
+
     std::unique_ptr<DeviceManager> device_manager_;
     std::unique_ptr<ActionSimulator> action_simulator_;
+    std::unique_ptr<CampaignManager> campaign_manager_;
+    DeviceEventBus event_bus_;
+    ServerMetrics metrics_;
+
+    // admission state for list-family RPCs; sheddable reads are counted
+    // here so an overload degrades listings instead of blocking writes
+    std::atomic<size_t> list_inflight_{0};
+    std::atomic<size_t> list_inflight_limit_{kDefaultListInflightLimit};
+
+    // admission state for long-lived watch streams, counted separately
+    // from the list tier because a stream holds its slot for minutes
+    std::atomic<size_t> watch_inflight_{0};
+    std::atomic<size_t> watch_inflight_limit_{kDefaultWatchInflightLimit};
     };
 }
 
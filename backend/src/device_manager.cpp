@@ -1,4 +1,9 @@
 #include "device_manager.h"
+#include "coarse_clock.h"
+#include "journal.h"
+#include "event_bus.h"
+#include <algorithm>
+#include <limits>
 #include <sstream>
 #include <random>
 #include <chrono> 
@@ -8,331 +13,1486 @@
 
 namespace device_management {
 
-DeviceManager::DeviceManager() = default;
+DeviceManager::DeviceManager(size_t shard_count) : journal_(nullptr), event_bus_(nullptr) {
+    if (shard_count == 0) {
+        shard_count = 1;
+    }
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
 
-DeviceManager::~DeviceManager() = default;
+DeviceManager::~DeviceManager() {
+    StopLivenessMonitor();
+}
 
-bool DeviceManager::RegisterDevice(const std::string& device_id,
-                                   const std::string& device_name,
-                                   const std::string& device_type,
-                                   DeviceStatus initial_status) {
-    // keep device map modifications behind a lock
-    std::lock_guard<std::mutex> lock(devices_mutex_);
-    
-    if (devices_.find(device_id) != devices_.end()) {
+void DeviceManager::AttachJournal(ChangeJournal* journal) {
+    journal_ = journal;
+}
+
+void DeviceManager::AttachEventBus(DeviceEventBus* event_bus) {
+    event_bus_ = event_bus;
+}
+
+void DeviceManager::PublishDeviceEvent(const Shard& shard, const DeviceData& device) {
+    // this runs with the shard lock held exclusively; with no watcher
+    // attached, building the DeviceInfo and taking the bus's global
+    // mutex would put a fleet-wide serialization point back into the
+    // heartbeat path for nothing
+    if (event_bus_ == nullptr || !event_bus_->HasSubscribers()) {
+        return;
+    }
+    DeviceInfo event;
+    FillDeviceInfo(shard, device, &event);
+    event_bus_->Publish(event);
+}
+
+size_t DeviceManager::ShardIndexFor(const std::string& device_id) const {
+    return std::hash<std::string>{}(device_id) % shards_.size();
+}
+
+DeviceManager::Shard& DeviceManager::ShardFor(const std::string& device_id) {
+    return *shards_[ShardIndexFor(device_id)];
+}
+
+bool DeviceManager::RegisterDeviceLocked(Shard& shard, const RegistrationEntry& entry) {
+    if (shard.devices.find(entry.device_id) != shard.devices.end()) {
         return false;
     }
-    
+
+    // the coarse clock turns the per-registration clock syscall into a
+    // relaxed load; device timestamps are second-granular anyway
+    auto now = CoarseClock::Now();
+
     DeviceData device;
-    device.device_id = device_id;
-    device.device_name = device_name;
-    device.device_type = device_type;
-    device.status = initial_status;
-    device.registered_at = std::chrono::system_clock::now();
-    device.last_updated = std::chrono::system_clock::now();
+    device.device_id = entry.device_id;
+    device.device_name = entry.device_name;
+    device.device_type = type_pool_.Intern(entry.device_type);
+    device.slot = shard.status.size();
+    device.registered_at = now;
     device.current_action_id = "";
-    
-    devices_[device_id] = device;
-    
+
+    // hot fields go into the shard's columns at the new slot
+    shard.status.push_back(entry.initial_status);
+    shard.last_updated.push_back(now);
+
+    TouchLocked(shard, entry.device_id, now);
+
+    shard.devices[entry.device_id] = device;
+    shard.by_status[entry.initial_status].insert(entry.device_id);
+    shard.by_type[entry.device_type].insert(entry.device_id);
+
+    device_count_.fetch_add(1, std::memory_order_relaxed);
+    status_counts_[entry.initial_status].fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> type_lock(type_counts_mutex_);
+        type_counts_[entry.device_type]++;
+    }
+
+    if (journal_ != nullptr) {
+        journal_->AppendRegister(entry.device_id, entry.device_name, entry.device_type,
+                                 static_cast<int32_t>(entry.initial_status),
+                                 std::chrono::duration_cast<std::chrono::seconds>(
+                                     now.time_since_epoch()).count());
+    }
+
     return true;
 }
 
-bool DeviceManager::SetDeviceStatus(const std::string& device_id, 
-                                    DeviceStatus status,
-                                    DeviceStatus* previous_status) {
-    // device status updates also go through the same lock
-    std::lock_guard<std::mutex> lock(devices_mutex_);
-    
-    auto it = devices_.find(device_id);
-    if (it == devices_.end()) {
+bool DeviceManager::RegisterDevice(const std::string& device_id,
+                                   const std::string& device_name,
+                                   const std::string& device_type,
+                                   DeviceStatus initial_status) {
+    // modifications only need the lock of the shard the device hashes to
+    Shard& shard = ShardFor(device_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    return RegisterDeviceLocked(shard, RegistrationEntry{device_id, device_name, device_type, initial_status});
+}
+
+std::vector<bool> DeviceManager::RegisterDevices(const std::vector<RegistrationEntry>& entries) {
+    std::vector<bool> results(entries.size(), false);
+
+    // bucket entry indices by shard so each shard lock is taken once
+    std::vector<std::vector<size_t>> by_shard(shards_.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        by_shard[ShardIndexFor(entries[i].device_id)].push_back(i);
+    }
+
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        if (by_shard[s].empty()) {
+            continue;
+        }
+        Shard& shard = *shards_[s];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+        for (size_t i : by_shard[s]) {
+            results[i] = RegisterDeviceLocked(shard, entries[i]);
+        }
+    }
+
+    return results;
+}
+
+bool DeviceManager::SetDeviceStatusLocked(Shard& shard, const std::string& device_id,
+                                          DeviceStatus status, DeviceStatus* previous_status) {
+    auto it = shard.devices.find(device_id);
+    if (it == shard.devices.end()) {
         return false;
     }
-    
+
+    const size_t slot = it->second.slot;
+
     if (previous_status != nullptr) {
-        *previous_status = it->second.status;
+        *previous_status = shard.status[slot];
+    }
+
+    if (shard.status[slot] != status) {
+        shard.by_status[shard.status[slot]].erase(device_id);
+        shard.by_status[status].insert(device_id);
+        status_counts_[shard.status[slot]].fetch_sub(1, std::memory_order_relaxed);
+        status_counts_[status].fetch_add(1, std::memory_order_relaxed);
     }
-    
-    it->second.status = status;
-    it->second.last_updated = std::chrono::system_clock::now();
-    
+
+    shard.status[slot] = status;
+    shard.last_updated[slot] = CoarseClock::Now();
+
+    TouchLocked(shard, device_id, shard.last_updated[slot]);
+
+    if (journal_ != nullptr) {
+        journal_->AppendStatus(device_id, static_cast<int32_t>(status),
+                               std::chrono::duration_cast<std::chrono::seconds>(
+                                   shard.last_updated[slot].time_since_epoch()).count());
+    }
+
+    PublishDeviceEvent(shard, it->second);
+
     return true;
 }
 
-std::unique_ptr<DeviceInfo> DeviceManager::GetDeviceInfo(const std::string& device_id) {
-    // read access still uses the mutex since devices_ can be written elsewhere
-    std::lock_guard<std::mutex> lock(devices_mutex_);
-    
-    auto it = devices_.find(device_id);
-    if (it == devices_.end()) {
-        return nullptr;
+bool DeviceManager::SetDeviceStatus(const std::string& device_id,
+                                    DeviceStatus status,
+                                    DeviceStatus* previous_status) {
+    // status updates go through the owning shard's lock
+    Shard& shard = ShardFor(device_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    return SetDeviceStatusLocked(shard, device_id, status, previous_status);
+}
+
+std::vector<bool> DeviceManager::SetDeviceStatusBatch(const std::vector<StatusUpdateEntry>& updates) {
+    std::vector<bool> results(updates.size(), false);
+
+    std::vector<std::vector<size_t>> by_shard(shards_.size());
+    for (size_t i = 0; i < updates.size(); ++i) {
+        by_shard[ShardIndexFor(updates[i].device_id)].push_back(i);
     }
-    
-    auto device_info = std::make_unique<DeviceInfo>();
-    const DeviceData& device = it->second;
-    
+
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        if (by_shard[s].empty()) {
+            continue;
+        }
+        Shard& shard = *shards_[s];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+        for (size_t i : by_shard[s]) {
+            results[i] = SetDeviceStatusLocked(shard, updates[i].device_id, updates[i].status, nullptr);
+        }
+    }
+
+    return results;
+}
+
+void DeviceManager::FillDeviceInfo(const Shard& shard, const DeviceData& device,
+                                   DeviceInfo* device_info) {
     device_info->set_device_id(device.device_id);
-    device_info->set_status(device.status);
+    device_info->set_status(shard.status[device.slot]);
     device_info->set_device_name(device.device_name);
-    device_info->set_device_type(device.device_type);
-    
+    device_info->set_device_type(*device.device_type);
+
     auto registered_time = std::chrono::duration_cast<std::chrono::seconds>(
         device.registered_at.time_since_epoch()).count();
     auto updated_time = std::chrono::duration_cast<std::chrono::seconds>(
-        device.last_updated.time_since_epoch()).count();
-    
+        shard.last_updated[device.slot].time_since_epoch()).count();
+
     device_info->set_registered_at(registered_time);
     device_info->set_last_updated(updated_time);
     device_info->set_current_action_id(device.current_action_id);
-    
+}
+
+std::unique_ptr<DeviceInfo> DeviceManager::GetDeviceInfo(const std::string& device_id) {
+    auto device_info = std::make_unique<DeviceInfo>();
+    if (!GetDeviceInfo(device_id, device_info.get())) {
+        return nullptr;
+    }
     return device_info;
 }
 
+bool DeviceManager::GetDeviceInfo(const std::string& device_id, DeviceInfo* out) {
+    // read access takes the shard lock shared so readers run in parallel
+    Shard& shard = ShardFor(device_id);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.devices.find(device_id);
+    if (it == shard.devices.end()) {
+        return false;
+    }
+
+    FillDeviceInfo(shard, it->second, out);
+    return true;
+}
+
 std::vector<DeviceInfo> DeviceManager::ListAllDevices() {
-    // take a snapshot of current devices under the lock and transform to protobuf objects
-    std::lock_guard<std::mutex> lock(devices_mutex_);
-    
+    // walk shard by shard, holding only one shard lock at a time
     std::vector<DeviceInfo> device_list;
-    device_list.reserve(devices_.size());
-    
-    for (const auto& pair : devices_) {
-        const DeviceData& device = pair.second;
-        
-        DeviceInfo device_info;
-        device_info.set_device_id(device.device_id);
-        device_info.set_status(device.status);
-        device_info.set_device_name(device.device_name);
-        device_info.set_device_type(device.device_type);
-        
-        auto registered_time = std::chrono::duration_cast<std::chrono::seconds>(
-            device.registered_at.time_since_epoch()).count();
-        auto updated_time = std::chrono::duration_cast<std::chrono::seconds>(
-            device.last_updated.time_since_epoch()).count();
-        
-        device_info.set_registered_at(registered_time);
-        device_info.set_last_updated(updated_time);
-        device_info.set_current_action_id(device.current_action_id);
-        
-        device_list.push_back(device_info);
-    }
-    
+
+    for (auto& shard_ptr : shards_) {
+        Shard& shard = *shard_ptr;
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+        for (const auto& pair : shard.devices) {
+            DeviceInfo device_info;
+            FillDeviceInfo(shard, pair.second, &device_info);
+            device_list.push_back(device_info);
+        }
+    }
+
     return device_list;
 }
 
+void DeviceManager::ListDevices(DeviceStatus status_filter,
+                                const std::string& device_type_filter,
+                                size_t page_size,
+                                uint64_t page_offset,
+                                bool* has_more,
+                                google::protobuf::RepeatedPtrField<DeviceInfo>* out) {
+    const bool filter_status = (status_filter != DeviceStatus::DEVICE_STATUS_UNKNOWN);
+    const bool filter_type = !device_type_filter.empty();
+
+    uint64_t remaining_skip = page_offset;
+    *has_more = false;
+
+    for (auto& shard_ptr : shards_) {
+        Shard& shard = *shard_ptr;
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+        // when a single index covers the filter, its size tells us how many
+        // matches the shard holds, so whole shards can be skipped unscanned
+        uint64_t shard_matches = 0;
+        bool shard_matches_known = true;
+        if (!filter_status && !filter_type) {
+            shard_matches = shard.devices.size();
+        } else if (filter_status && !filter_type) {
+            auto idx = shard.by_status.find(status_filter);
+            shard_matches = (idx != shard.by_status.end()) ? idx->second.size() : 0;
+        } else if (!filter_status && filter_type) {
+            auto idx = shard.by_type.find(device_type_filter);
+            shard_matches = (idx != shard.by_type.end()) ? idx->second.size() : 0;
+        } else {
+            shard_matches_known = false;
+        }
+
+        if (shard_matches_known && remaining_skip >= shard_matches) {
+            remaining_skip -= shard_matches;
+            continue;
+        }
+
+        // emit one matching device, or count it toward the skip / has_more
+        auto visit = [&](const DeviceData& device) {
+            if (remaining_skip > 0) {
+                remaining_skip--;
+                return true;
+            }
+            if (static_cast<size_t>(out->size()) >= page_size) {
+                *has_more = true;
+                return false;
+            }
+            FillDeviceInfo(shard, device, out->Add());
+            return true;
+        };
+
+        bool keep_going = true;
+        if (filter_status) {
+            auto idx = shard.by_status.find(status_filter);
+            if (idx != shard.by_status.end()) {
+                for (const auto& id : idx->second) {
+                    const DeviceData& device = shard.devices.at(id);
+                    if (filter_type && *device.device_type != device_type_filter) {
+                        continue;
+                    }
+                    if (!(keep_going = visit(device))) break;
+                }
+            }
+        } else if (filter_type) {
+            auto idx = shard.by_type.find(device_type_filter);
+            if (idx != shard.by_type.end()) {
+                for (const auto& id : idx->second) {
+                    if (!(keep_going = visit(shard.devices.at(id)))) break;
+                }
+            }
+        } else {
+            for (const auto& pair : shard.devices) {
+                if (!(keep_going = visit(pair.second))) break;
+            }
+        }
+
+        if (!keep_going) {
+            break;
+        }
+    }
+}
+
+void DeviceManager::QueryDevices(DeviceStatus status_filter,
+                                 const std::string& device_type_filter,
+                                 google::protobuf::RepeatedPtrField<DeviceInfo>* out) {
+    // the paged walk already answers index-covered filters in O(result);
+    // an unpaged query is just its degenerate single-page form
+    bool has_more = false;
+    ListDevices(status_filter, device_type_filter,
+                std::numeric_limits<size_t>::max(), 0, &has_more, out);
+}
+
+void DeviceManager::StreamDevices(size_t chunk_size,
+                                  const std::function<bool(std::vector<DeviceInfo>&)>& emit) {
+    if (chunk_size == 0) {
+        chunk_size = 1;
+    }
+
+    std::vector<DeviceInfo> chunk;
+    chunk.reserve(chunk_size);
+
+    for (auto& shard_ptr : shards_) {
+        Shard& shard = *shard_ptr;
+
+        // snapshot the shard's ids under one brief lock; device ids are
+        // small compared to full DeviceInfo messages, and the snapshot
+        // keeps chunk positions stable while the lock is dropped
+        std::vector<std::string> ids;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            ids.reserve(shard.devices.size());
+            for (const auto& pair : shard.devices) {
+                ids.push_back(pair.first);
+            }
+        }
+
+        for (size_t start = 0; start < ids.size(); start += chunk_size) {
+            chunk.clear();
+            {
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                size_t end = std::min(start + chunk_size, ids.size());
+                for (size_t i = start; i < end; ++i) {
+                    auto it = shard.devices.find(ids[i]);
+                    if (it == shard.devices.end()) {
+                        continue;
+                    }
+                    DeviceInfo device_info;
+                    FillDeviceInfo(shard, it->second, &device_info);
+                    chunk.push_back(std::move(device_info));
+                }
+            }
+
+            if (!chunk.empty() && !emit(chunk)) {
+                return;
+            }
+        }
+    }
+}
+
 bool DeviceManager::SetDeviceAction(const std::string& device_id, const std::string& action_id) {
-    std::lock_guard<std::mutex> lock(devices_mutex_);
-    
-    auto it = devices_.find(device_id);
-    if (it == devices_.end()) {
+    Shard& shard = ShardFor(device_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.devices.find(device_id);
+    if (it == shard.devices.end()) {
         return false;
     }
-    
+
     it->second.current_action_id = action_id;
-    it->second.last_updated = std::chrono::system_clock::now();
-    
+    shard.last_updated[it->second.slot] = CoarseClock::Now();
+    TouchLocked(shard, device_id, shard.last_updated[it->second.slot]);
+
+    if (journal_ != nullptr) {
+        journal_->AppendSetAction(device_id, action_id,
+                                  std::chrono::duration_cast<std::chrono::seconds>(
+                                      shard.last_updated[it->second.slot].time_since_epoch()).count());
+    }
+
+    PublishDeviceEvent(shard, it->second);
+
     return true;
 }
 
 bool DeviceManager::ClearDeviceAction(const std::string& device_id) {
-    std::lock_guard<std::mutex> lock(devices_mutex_);
-    
-    auto it = devices_.find(device_id);
-    if (it == devices_.end()) {
+    Shard& shard = ShardFor(device_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.devices.find(device_id);
+    if (it == shard.devices.end()) {
         return false;
     }
-    
+
     it->second.current_action_id = "";
-    it->second.last_updated = std::chrono::system_clock::now();
-    
+    shard.last_updated[it->second.slot] = CoarseClock::Now();
+    TouchLocked(shard, device_id, shard.last_updated[it->second.slot]);
+
+    if (journal_ != nullptr) {
+        journal_->AppendClearAction(device_id,
+                                    std::chrono::duration_cast<std::chrono::seconds>(
+                                        shard.last_updated[it->second.slot].time_since_epoch()).count());
+    }
+
+    PublishDeviceEvent(shard, it->second);
+
     return true;
 }
 
 bool DeviceManager::DeviceExists(const std::string& device_id) {
-    std::lock_guard<std::mutex> lock(devices_mutex_);
-    
-    return devices_.find(device_id) != devices_.end();
+    Shard& shard = ShardFor(device_id);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+    return shard.devices.find(device_id) != shard.devices.end();
 }
 
-ActionSimulator::ActionSimulator(DeviceManager* device_manager)
-    : device_manager_(device_manager), action_id_counter_(0), shutdown_requested_(false) {
+size_t DeviceManager::DeviceCount() {
+    return device_count_.load(std::memory_order_relaxed);
+}
+
+std::array<uint64_t, 8> DeviceManager::StatusCounts() const {
+    std::array<uint64_t, 8> counts{};
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] = status_counts_[i].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+std::vector<std::pair<std::string, uint64_t>> DeviceManager::TypeCounts() {
+    std::lock_guard<std::mutex> lock(type_counts_mutex_);
+    return std::vector<std::pair<std::string, uint64_t>>(type_counts_.begin(), type_counts_.end());
+}
+
+std::vector<DeviceManager::DeviceRecord> DeviceManager::ExportDevices() {
+    std::vector<DeviceRecord> records;
+
+    for (auto& shard_ptr : shards_) {
+        Shard& shard = *shard_ptr;
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+        for (const auto& pair : shard.devices) {
+            const DeviceData& device = pair.second;
+
+            DeviceRecord record;
+            record.device_id = device.device_id;
+            record.device_name = device.device_name;
+            record.device_type = *device.device_type;
+            record.status = shard.status[device.slot];
+            record.registered_at = std::chrono::duration_cast<std::chrono::seconds>(
+                device.registered_at.time_since_epoch()).count();
+            record.last_updated = std::chrono::duration_cast<std::chrono::seconds>(
+                shard.last_updated[device.slot].time_since_epoch()).count();
+
+            records.push_back(std::move(record));
+        }
+    }
+
+    return records;
+}
+
+void DeviceManager::ExportDevicesChunked(size_t chunk_size,
+                                         const std::function<bool(std::vector<DeviceRecord>&)>& emit) {
+    if (chunk_size == 0) {
+        chunk_size = 1;
+    }
+
+    for (auto& shard_ptr : shards_) {
+        Shard& shard = *shard_ptr;
+
+        // copy the whole shard under one shared lock, then hand it out in
+        // chunk-size slices with no lock held, so a slow consumer never
+        // stalls writers to this shard
+        std::vector<DeviceRecord> records;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            records.reserve(shard.devices.size());
+
+            for (const auto& pair : shard.devices) {
+                const DeviceData& device = pair.second;
+
+                DeviceRecord record;
+                record.device_id = device.device_id;
+                record.device_name = device.device_name;
+                record.device_type = *device.device_type;
+                record.status = shard.status[device.slot];
+                record.registered_at = std::chrono::duration_cast<std::chrono::seconds>(
+                    device.registered_at.time_since_epoch()).count();
+                record.last_updated = std::chrono::duration_cast<std::chrono::seconds>(
+                    shard.last_updated[device.slot].time_since_epoch()).count();
+
+                records.push_back(std::move(record));
+            }
+        }
+
+        std::vector<DeviceRecord> chunk;
+        for (size_t start = 0; start < records.size(); start += chunk_size) {
+            size_t end = std::min(start + chunk_size, records.size());
+            chunk.assign(std::make_move_iterator(records.begin() + start),
+                         std::make_move_iterator(records.begin() + end));
+            if (!emit(chunk)) {
+                return;
+            }
+        }
+    }
+}
+
+size_t DeviceManager::RestoreDevices(const std::vector<DeviceRecord>& records) {
+    size_t inserted = 0;
+
+    std::vector<std::vector<size_t>> by_shard(shards_.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        by_shard[ShardIndexFor(records[i].device_id)].push_back(i);
+    }
+
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        if (by_shard[s].empty()) {
+            continue;
+        }
+        Shard& shard = *shards_[s];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+        for (size_t i : by_shard[s]) {
+            const DeviceRecord& record = records[i];
+            if (shard.devices.find(record.device_id) != shard.devices.end()) {
+                continue;
+            }
+
+            DeviceData device;
+            device.device_id = record.device_id;
+            device.device_name = record.device_name;
+            device.device_type = type_pool_.Intern(record.device_type);
+            device.slot = shard.status.size();
+            device.registered_at = std::chrono::system_clock::time_point(
+                std::chrono::seconds(record.registered_at));
+            device.current_action_id = "";
+
+            shard.status.push_back(record.status);
+            shard.last_updated.push_back(std::chrono::system_clock::time_point(
+                std::chrono::seconds(record.last_updated)));
+
+            shard.devices[record.device_id] = device;
+            shard.by_status[record.status].insert(record.device_id);
+            shard.by_type[record.device_type].insert(record.device_id);
+
+            device_count_.fetch_add(1, std::memory_order_relaxed);
+            status_counts_[record.status].fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> type_lock(type_counts_mutex_);
+                type_counts_[record.device_type]++;
+            }
+            inserted++;
+        }
+    }
+
+    return inserted;
+}
+
+bool DeviceManager::RestoreDeviceStatus(const std::string& device_id, DeviceStatus status,
+                                        int64_t last_updated) {
+    Shard& shard = ShardFor(device_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+    auto it = shard.devices.find(device_id);
+    if (it == shard.devices.end()) {
+        return false;
+    }
+
+    const size_t slot = it->second.slot;
+
+    auto updated_at = std::chrono::system_clock::time_point(std::chrono::seconds(last_updated));
+    if (updated_at < shard.last_updated[slot]) {
+        return false;
+    }
+
+    if (shard.status[slot] != status) {
+        shard.by_status[shard.status[slot]].erase(device_id);
+        shard.by_status[status].insert(device_id);
+        status_counts_[shard.status[slot]].fetch_sub(1, std::memory_order_relaxed);
+        status_counts_[status].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    shard.status[slot] = status;
+    shard.last_updated[slot] = updated_at;
+
+    return true;
+}
+
+DeviceManager::CreateGroupResult DeviceManager::CreateGroup(const std::string& group_id,
+                                                            const std::string& parent_group_id) {
+    std::unique_lock<std::shared_mutex> lock(groups_mutex_);
+
+    if (groups_.count(group_id) > 0) {
+        return CreateGroupResult::kAlreadyExists;
+    }
+
+    if (!parent_group_id.empty()) {
+        auto parent = groups_.find(parent_group_id);
+        if (parent == groups_.end()) {
+            return CreateGroupResult::kParentNotFound;
+        }
+        parent->second.children.push_back(group_id);
+    }
+
+    Group& group = groups_[group_id];
+    group.parent_id = parent_group_id;
+
+    return CreateGroupResult::kCreated;
+}
+
+bool DeviceManager::AssignDeviceToGroup(const std::string& device_id,
+                                        const std::string& group_id,
+                                        std::string* error) {
+    // membership checks never touch shard locks, so the existence probe
+    // runs before groups_mutex_ is taken
+    if (!DeviceExists(device_id)) {
+        *error = "Device with ID '" + device_id + "' not found";
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(groups_mutex_);
+
+    auto it = groups_.find(group_id);
+    if (it == groups_.end()) {
+        *error = "Group with ID '" + group_id + "' not found";
+        return false;
+    }
+
+    auto previous = device_group_.find(device_id);
+    if (previous != device_group_.end()) {
+        groups_[previous->second].devices.erase(device_id);
+    }
+
+    it->second.devices.insert(device_id);
+    device_group_[device_id] = group_id;
+
+    return true;
+}
+
+void DeviceManager::CollectGroupDevicesLocked(const Group& group,
+                                              std::vector<std::string>* out) const {
+    out->insert(out->end(), group.devices.begin(), group.devices.end());
+    for (const auto& child_id : group.children) {
+        CollectGroupDevicesLocked(groups_.at(child_id), out);
+    }
+}
+
+bool DeviceManager::GroupDeviceIds(const std::string& group_id,
+                                   std::vector<std::string>* out) {
+    std::shared_lock<std::shared_mutex> lock(groups_mutex_);
+
+    auto it = groups_.find(group_id);
+    if (it == groups_.end()) {
+        return false;
+    }
+
+    CollectGroupDevicesLocked(it->second, out);
+    return true;
+}
+
+bool DeviceManager::SetGroupStatus(const std::string& group_id, DeviceStatus status,
+                                   size_t* updated) {
+    *updated = 0;
+
+    // snapshot the subtree's ids first; groups_mutex_ is released before
+    // any shard lock is taken
+    std::vector<std::string> device_ids;
+    if (!GroupDeviceIds(group_id, &device_ids)) {
+        return false;
+    }
+
+    // same shard-bucketed sweep as SetDeviceStatusBatch: one exclusive
+    // lock acquisition per shard the group actually touches
+    std::vector<std::vector<size_t>> by_shard(shards_.size());
+    for (size_t i = 0; i < device_ids.size(); ++i) {
+        by_shard[ShardIndexFor(device_ids[i])].push_back(i);
+    }
+
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        if (by_shard[s].empty()) {
+            continue;
+        }
+        Shard& shard = *shards_[s];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+        for (size_t i : by_shard[s]) {
+            if (SetDeviceStatusLocked(shard, device_ids[i], status, nullptr)) {
+                (*updated)++;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool DeviceManager::ListGroupDevices(const std::string& group_id,
+                                     size_t page_size,
+                                     uint64_t page_offset,
+                                     bool* has_more,
+                                     google::protobuf::RepeatedPtrField<DeviceInfo>* out) {
+    *has_more = false;
+
+    std::vector<std::string> device_ids;
+    if (!GroupDeviceIds(group_id, &device_ids)) {
+        return false;
+    }
+
+    // membership sets are unordered, so sort the snapshot to give offset
+    // paging a stable order across requests
+    std::sort(device_ids.begin(), device_ids.end());
+
+    if (page_offset >= device_ids.size()) {
+        return true;
+    }
+
+    size_t end = device_ids.size();
+    if (page_size < end - page_offset) {
+        end = page_offset + page_size;
+        *has_more = true;
+    }
+
+    for (size_t i = page_offset; i < end; ++i) {
+        Shard& shard = ShardFor(device_ids[i]);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+        auto it = shard.devices.find(device_ids[i]);
+        if (it == shard.devices.end()) {
+            continue;
+        }
+        FillDeviceInfo(shard, it->second, out->Add());
+    }
+
+    return true;
+}
+
+void DeviceManager::TouchLocked(Shard& shard, const std::string& device_id,
+                                std::chrono::system_clock::time_point when) {
+    if (!liveness_enabled_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    shard.touch_log.emplace_back(when, device_id);
+}
+
+void DeviceManager::SweepStaleDevices(std::chrono::seconds ttl) {
+    auto cutoff = std::chrono::system_clock::now() - ttl;
+
+    for (auto& shard_ptr : shards_) {
+        Shard& shard = *shard_ptr;
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+        // the log is time-ordered, so only the expired prefix is walked;
+        // devices touched again since have a fresher entry further back
+        // and their stale ones are simply dropped here
+        while (!shard.touch_log.empty() && shard.touch_log.front().first <= cutoff) {
+            std::string device_id = std::move(shard.touch_log.front().second);
+            shard.touch_log.pop_front();
+
+            auto it = shard.devices.find(device_id);
+            if (it == shard.devices.end()) {
+                continue;
+            }
+            const size_t slot = it->second.slot;
+            if (shard.last_updated[slot] > cutoff ||
+                shard.status[slot] == DeviceStatus::OFFLINE) {
+                continue;
+            }
+
+            // goes through the regular mutator so the transition is
+            // journaled and published like any client-driven change
+            SetDeviceStatusLocked(shard, device_id, DeviceStatus::OFFLINE, nullptr);
+        }
+    }
+}
+
+void DeviceManager::LivenessLoop(int ttl_seconds) {
+    // sweeping at a quarter of the TTL keeps expiry latency well under
+    // half a TTL without burning cycles on tight loops
+    auto sweep_interval = std::chrono::seconds(std::max(1, ttl_seconds / 4));
+
+    std::unique_lock<std::mutex> lock(liveness_mutex_);
+    while (liveness_running_) {
+        liveness_cv_.wait_for(lock, sweep_interval);
+        if (!liveness_running_) {
+            break;
+        }
+        lock.unlock();
+        SweepStaleDevices(std::chrono::seconds(ttl_seconds));
+        lock.lock();
+    }
+}
+
+void DeviceManager::StartLivenessMonitor(int ttl_seconds) {
+    if (ttl_seconds <= 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(liveness_mutex_);
+        if (liveness_running_) {
+            return;
+        }
+        liveness_running_ = true;
+    }
+    liveness_enabled_.store(true, std::memory_order_relaxed);
+
+    // seed the logs with the current fleet so devices that never
+    // heartbeat again still expire
+    for (auto& shard_ptr : shards_) {
+        Shard& shard = *shard_ptr;
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        for (const auto& pair : shard.devices) {
+            shard.touch_log.emplace_back(shard.last_updated[pair.second.slot], pair.first);
+        }
+        std::sort(shard.touch_log.begin(), shard.touch_log.end());
+    }
+
+    liveness_thread_ = std::thread([this, ttl_seconds]() { LivenessLoop(ttl_seconds); });
+}
+
+void DeviceManager::StopLivenessMonitor() {
+    {
+        std::lock_guard<std::mutex> lock(liveness_mutex_);
+        if (!liveness_running_) {
+            return;
+        }
+        liveness_running_ = false;
+    }
+    liveness_enabled_.store(false, std::memory_order_relaxed);
+    liveness_cv_.notify_all();
+    if (liveness_thread_.joinable()) {
+        liveness_thread_.join();
+    }
+}
+
+ActionSimulator::ActionSimulator(DeviceManager* device_manager, size_t worker_count,
+                                 size_t retired_capacity)
+    : retired_capacity_(retired_capacity), retired_next_(0),
+      device_manager_(device_manager), action_id_counter_(0),
+      live_action_count_(0), total_action_count_(0), shutdown_requested_(false) {
+    if (retired_capacity_ == 0) {
+        retired_capacity_ = 1;
+    }
+    if (worker_count == 0) {
+        worker_count = 1;
+    }
+    workers_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back([this]() { this->WorkerLoop(); });
+    }
 }
 
 ActionSimulator::~ActionSimulator() {
     Shutdown();
 }
 
-std::string ActionSimulator::InitiateAction(const std::string& device_id,
-                                            ActionType action_type,
-                                            const std::map<std::string, std::string>& action_params,
-                                            std::function<void(const std::string&, ActionStatus)> status_callback) {
-    std::string action_id = GenerateActionId();
-    
-    auto action_data = std::make_unique<ActionData>();
+uint64_t ActionSimulator::InitiateAction(const std::string& device_id,
+                                         ActionType action_type,
+                                         const std::map<std::string, std::string>& action_params,
+                                         std::function<void(uint64_t, ActionStatus)> status_callback,
+                                         int* queue_position) {
+    uint64_t action_id = GenerateActionId();
+
+    auto action_data = std::make_shared<ActionData>();
     action_data->action_id = action_id;
     action_data->device_id = device_id;
     action_data->action_type = action_type;
-    action_data->status = ActionStatus::PENDING;
+    action_data->status.store(ActionStatus::PENDING, std::memory_order_relaxed);
     action_data->action_params = action_params;
-    action_data->initiated_at = std::chrono::system_clock::now();
-    action_data->completed_at = std::chrono::system_clock::time_point::min();
+    action_data->initiated_at = CoarseClock::Now();
     action_data->error_message = "";
+    action_data->status_callback = status_callback;
     action_data->should_stop = false;
-    
+
+    // pick the simulated duration up front; workers advance the action
+    // one tick per second until it has run for this long
+    static thread_local std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<> dis(10, 30);
+    action_data->duration_seconds = dis(gen);
+    action_data->elapsed_ticks = 0;
+
+    bool queued = false;
+    int position = 0;
     {
         std::lock_guard<std::mutex> lock(actions_mutex_);
-        ActionData* raw_ptr = action_data.get();
+
+        // a busy device queues the action instead of rejecting it; the
+        // queue is bounded so a stuck device cannot accumulate work forever
+        auto active_it = active_actions_.find(device_id);
+        if (active_it != active_actions_.end()) {
+            std::deque<uint64_t>& queue = device_queues_[device_id];
+            if (queue.size() >= kMaxQueuedPerDevice) {
+                return 0;
+            }
+            action_data->status.store(ActionStatus::QUEUED, std::memory_order_release);
+            queue.push_back(action_id);
+            position = static_cast<int>(queue.size());
+            queued = true;
+        } else {
+            ActivateActionLocked(*action_data);
+        }
+
         actions_[action_id] = std::move(action_data);
-        
-        raw_ptr->simulation_thread = std::thread([this, action_id, device_id, action_type, status_callback, raw_ptr]() {
-            this->SimulateAction(action_id, device_id, action_type, status_callback);
-        });
-    }
-    
-    device_manager_->SetDeviceAction(device_id, action_id);
-    
-    {
-        std::lock_guard<std::mutex> lock(actions_mutex_);
-        auto it = actions_.find(action_id);
-        if (it != actions_.end()) {
-            it->second->status = ActionStatus::RUNNING;
+    }
+    live_action_count_.fetch_add(1, std::memory_order_relaxed);
+    total_action_count_.fetch_add(1, std::memory_order_relaxed);
+
+    if (queue_position != nullptr) {
+        *queue_position = position;
+    }
+
+    if (queued) {
+        if (status_callback) {
+            status_callback(action_id, ActionStatus::QUEUED);
         }
+        return action_id;
     }
-    
+
+    StartAction(action_id, device_id, action_type, status_callback);
+
+    return action_id;
+}
+
+void ActionSimulator::ActivateActionLocked(ActionData& action) {
+    action.status.store(ActionStatus::RUNNING, std::memory_order_release);
+    active_actions_[action.device_id] = action.action_id;
+}
+
+void ActionSimulator::StartAction(uint64_t action_id, const std::string& device_id,
+                                  ActionType action_type,
+                                  const std::function<void(uint64_t, ActionStatus)>& status_callback) {
+    // the device record carries the wire form, formatted once here
+    device_manager_->SetDeviceAction(device_id, FormatActionId(action_id));
+
+    ScheduleTick(action_id, std::chrono::steady_clock::now() + std::chrono::seconds(1));
+
     DeviceStatus device_status = DeviceStatus::BUSY;
     if (action_type == ActionType::SOFTWARE_UPDATE || action_type == ActionType::FIRMWARE_UPDATE) {
         device_status = DeviceStatus::UPDATING;
     }
     device_manager_->SetDeviceStatus(device_id, device_status);
-    
+
     if (status_callback) {
         status_callback(action_id, ActionStatus::RUNNING);
     }
-    
-    return action_id;
 }
 
-std::unique_ptr<ActionInfo> ActionSimulator::GetActionStatus(const std::string& action_id) {
+ActionSimulator::CancelResult ActionSimulator::CancelAction(uint64_t action_id) {
+    std::function<void(uint64_t, ActionStatus)> callback;
+    bool finalized_here = false;
+
+    {
+        std::lock_guard<std::mutex> lock(actions_mutex_);
+
+        auto it = actions_.find(action_id);
+        if (it == actions_.end()) {
+            return CancelResult::kNotFound;
+        }
+
+        ActionData& action = *it->second;
+        ActionStatus status = action.status.load(std::memory_order_relaxed);
+        if (status == ActionStatus::COMPLETED || status == ActionStatus::FAILED) {
+            return CancelResult::kAlreadyFinished;
+        }
+
+        action.should_stop = true;
+
+        // a queued (or not-yet-started) action holds no device, so it is
+        // finalized right here instead of waiting for a worker
+        if (status == ActionStatus::QUEUED || status == ActionStatus::PENDING) {
+            auto queue_it = device_queues_.find(action.device_id);
+            if (queue_it != device_queues_.end()) {
+                auto& queue = queue_it->second;
+                queue.erase(std::remove(queue.begin(), queue.end(), action_id), queue.end());
+                if (queue.empty()) {
+                    device_queues_.erase(queue_it);
+                }
+            }
+
+            // terminal fields first, status store last (release) so
+            // lock-free readers never see FAILED with a torn message
+            action.error_message = "Action was cancelled";
+            action.completed_at_secs.store(std::chrono::duration_cast<std::chrono::seconds>(
+                CoarseClock::Now().time_since_epoch()).count(),
+                std::memory_order_relaxed);
+            action.status.store(ActionStatus::FAILED, std::memory_order_release);
+            live_action_count_.fetch_sub(1, std::memory_order_relaxed);
+            RecordCompletionLocked(false);
+            AppendHistory(action);
+            callback = action.status_callback;
+            RetireActionLocked(action_id);
+            finalized_here = true;
+        }
+    }
+
+    if (finalized_here) {
+        if (callback) {
+            callback(action_id, ActionStatus::FAILED);
+        }
+        return CancelResult::kCancelled;
+    }
+
+    // running: schedule an immediate tick so a worker observes the stop
+    // flag within milliseconds rather than at its next one-second wake
+    ScheduleTick(action_id, std::chrono::steady_clock::now());
+    return CancelResult::kCancelled;
+}
+
+std::unique_ptr<ActionInfo> ActionSimulator::GetActionStatus(uint64_t action_id) {
+    auto action_info = std::make_unique<ActionInfo>();
+    if (!GetActionStatus(action_id, action_info.get())) {
+        return nullptr;
+    }
+    return action_info;
+}
+
+bool ActionSimulator::GetActionStatus(uint64_t action_id, ActionInfo* out) {
+    // the mutex covers only the map lookup; the shared_ptr keeps the
+    // action alive while its fields are copied lock-free below, so 1Hz
+    // polls across thousands of actions never serialize on the workers
+    std::shared_ptr<const ActionData> action;
+    {
+        std::lock_guard<std::mutex> lock(actions_mutex_);
+
+        auto it = actions_.find(action_id);
+        if (it == actions_.end()) {
+            // finished actions live on as compact records in the retirement ring
+            auto retired_it = retired_index_.find(action_id);
+            if (retired_it == retired_index_.end()) {
+                return false;
+            }
+
+            const RetiredAction& retired = retired_ring_[retired_it->second];
+            out->set_action_id(FormatActionId(retired.action_id));
+            out->set_device_id(retired.device_id);
+            out->set_action_type(retired.action_type);
+            out->set_status(retired.status);
+            out->set_initiated_at(std::chrono::duration_cast<std::chrono::seconds>(
+                retired.initiated_at.time_since_epoch()).count());
+            out->set_completed_at(std::chrono::duration_cast<std::chrono::seconds>(
+                retired.completed_at.time_since_epoch()).count());
+            out->set_error_message(retired.error_message);
+            return true;
+        }
+
+        action = it->second;
+    }
+
+    out->set_action_id(FormatActionId(action->action_id));
+    out->set_device_id(action->device_id);
+    out->set_action_type(action->action_type);
+
+    // acquire pairs with the writer's release store: once a terminal
+    // status is visible, error_message and completed_at are stable
+    ActionStatus status = action->status.load(std::memory_order_acquire);
+    out->set_status(status);
+
+    for (const auto& param : action->action_params) {
+        (*out->mutable_action_params())[param.first] = param.second;
+    }
+
+    auto initiated_time = std::chrono::duration_cast<std::chrono::seconds>(
+        action->initiated_at.time_since_epoch()).count();
+    out->set_initiated_at(initiated_time);
+    out->set_completed_at(action->completed_at_secs.load(std::memory_order_relaxed));
+
+    if (status == ActionStatus::COMPLETED || status == ActionStatus::FAILED) {
+        out->set_error_message(action->error_message);
+    }
+
+    return true;
+}
+
+size_t ActionSimulator::LiveActionCount() const {
+    return live_action_count_.load(std::memory_order_relaxed);
+}
+
+size_t ActionSimulator::TotalActionCount() {
+    return total_action_count_.load(std::memory_order_relaxed);
+}
+
+void ActionSimulator::RecordCompletionLocked(bool success) {
+    int64_t minute = std::chrono::duration_cast<std::chrono::minutes>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    CompletionBucket& bucket = completion_buckets_[minute % 60];
+    if (bucket.minute != minute) {
+        bucket.minute = minute;
+        bucket.completed = 0;
+        bucket.failed = 0;
+    }
+    if (success) {
+        bucket.completed++;
+    } else {
+        bucket.failed++;
+    }
+}
+
+void ActionSimulator::CompletionCountsLastHour(uint64_t* completed, uint64_t* failed) {
+    int64_t now_minute = std::chrono::duration_cast<std::chrono::minutes>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    *completed = 0;
+    *failed = 0;
+
     std::lock_guard<std::mutex> lock(actions_mutex_);
-    
+    for (const CompletionBucket& bucket : completion_buckets_) {
+        if (bucket.minute >= 0 && now_minute - bucket.minute < 60) {
+            *completed += bucket.completed;
+            *failed += bucket.failed;
+        }
+    }
+}
+
+void ActionSimulator::RetireActionLocked(uint64_t action_id) {
     auto it = actions_.find(action_id);
     if (it == actions_.end()) {
-        return nullptr;
+        return;
     }
-    
-    const ActionData& action = *(it->second);
-    auto action_info = std::make_unique<ActionInfo>();
-    
-    action_info->set_action_id(action.action_id);
-    action_info->set_device_id(action.device_id);
-    action_info->set_action_type(action.action_type);
-    action_info->set_status(action.status);
-    
-    for (const auto& param : action.action_params) {
-        (*action_info->mutable_action_params())[param.first] = param.second;
-    }
-    
-    auto initiated_time = std::chrono::duration_cast<std::chrono::seconds>(
-        action.initiated_at.time_since_epoch()).count();
-    action_info->set_initiated_at(initiated_time);
-    
-    if (action.completed_at != std::chrono::system_clock::time_point::min()) {
-        auto completed_time = std::chrono::duration_cast<std::chrono::seconds>(
-            action.completed_at.time_since_epoch()).count();
-        action_info->set_completed_at(completed_time);
+
+    const ActionData& action = *it->second;
+
+    RetiredAction retired;
+    retired.action_id = action.action_id;
+    retired.device_id = action.device_id;
+    retired.action_type = action.action_type;
+    retired.status = action.status.load(std::memory_order_relaxed);
+    retired.initiated_at = action.initiated_at;
+    retired.completed_at = std::chrono::system_clock::time_point(
+        std::chrono::seconds(action.completed_at_secs.load(std::memory_order_relaxed)));
+    retired.error_message = action.error_message;
+
+    if (retired_ring_.size() < retired_capacity_) {
+        retired_index_[retired.action_id] = retired_ring_.size();
+        retired_ring_.push_back(std::move(retired));
     } else {
-        action_info->set_completed_at(0);
+        // overwrite the oldest slot and drop its id from the index
+        size_t slot = retired_next_ % retired_capacity_;
+        retired_index_.erase(retired_ring_[slot].action_id);
+        retired_index_[retired.action_id] = slot;
+        retired_ring_[slot] = std::move(retired);
     }
-    
-    action_info->set_error_message(action.error_message);
-    
-    return action_info;
+    retired_next_ = (retired_next_ + 1) % retired_capacity_;
+
+    actions_.erase(it);
 }
 
 void ActionSimulator::Shutdown() {
-    shutdown_requested_ = true;
-    
+    if (shutdown_requested_.exchange(true)) {
+        return;
+    }
+
+    // fast drain: finalize every non-terminal action as cancelled in one
+    // pass under the lock, collecting the callbacks to run later, then
+    // release the lock before waking and joining the workers. nothing
+    // sleeps per action, so shutdown cost is one map sweep plus at most
+    // one in-flight tick per worker regardless of how much is pending
+    std::vector<std::pair<uint64_t,
+                          std::function<void(uint64_t, ActionStatus)>>> cancelled;
     {
         std::lock_guard<std::mutex> lock(actions_mutex_);
-        for (auto& pair : actions_) {
-            pair.second->should_stop = true;
+        cancelled.reserve(actions_.size());
+        while (!actions_.empty()) {
+            ActionData& action = *actions_.begin()->second;
+            action.should_stop = true;
+            ActionStatus status = action.status.load(std::memory_order_relaxed);
+            if (status == ActionStatus::PENDING || status == ActionStatus::RUNNING ||
+                status == ActionStatus::QUEUED) {
+                // terminal fields first, status store last (release) so
+                // lock-free readers never see FAILED with a torn message
+                action.error_message = "Action was cancelled";
+                action.completed_at_secs.store(std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count(),
+                    std::memory_order_relaxed);
+                action.status.store(ActionStatus::FAILED, std::memory_order_release);
+                live_action_count_.fetch_sub(1, std::memory_order_relaxed);
+                RecordCompletionLocked(false);
+                AppendHistory(action);
+                if (action.status_callback) {
+                    cancelled.emplace_back(action.action_id, action.status_callback);
+                }
+            }
+            // retirement keeps the final status visible to late lookups
+            RetireActionLocked(action.action_id);
         }
+        active_actions_.clear();
+        device_queues_.clear();
     }
-    
+
+    // notify under timer_mutex_ so a worker that has seen
+    // shutdown_requested_ false but not yet entered wait() cannot miss
+    // this one-and-only wakeup and sleep forever
     {
-        std::lock_guard<std::mutex> lock(actions_mutex_);
-        for (auto& pair : actions_) {
-            if (pair.second->simulation_thread.joinable()) {
-                pair.second->simulation_thread.join();
-            }
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        timer_cv_.notify_all();
+    }
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
         }
     }
+
+    // completion callbacks run only after the workers are gone, so they
+    // never race a tick for the same action
+    for (auto& entry : cancelled) {
+        entry.second(entry.first, ActionStatus::FAILED);
+    }
 }
 
-void ActionSimulator::SimulateAction(const std::string& action_id,
-                                    const std::string& device_id,
-                                    ActionType action_type,
-                                    std::function<void(const std::string&, ActionStatus)> status_callback) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(10, 30);
-    
-    int duration_seconds = dis(gen);
-    
-    bool should_stop = false;
-    for (int i = 0; i < duration_seconds && !should_stop; ++i) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        
-        {
-            std::lock_guard<std::mutex> lock(actions_mutex_);
-            auto it = actions_.find(action_id);
-            if (it != actions_.end() && it->second->should_stop) {
-                should_stop = true;
-            }
+void ActionSimulator::AppendHistory(const ActionData& action) {
+    HistoryRecord record;
+    record.action_id = action.action_id;
+    record.action_type = action.action_type;
+    record.status = action.status.load(std::memory_order_relaxed);
+    record.initiated_at = std::chrono::duration_cast<std::chrono::seconds>(
+        action.initiated_at.time_since_epoch()).count();
+    record.completed_at = action.completed_at_secs.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(history_mutex_);
+    std::deque<HistoryRecord>& ledger = history_[action.device_id];
+    ledger.push_back(record);
+    if (ledger.size() > kMaxHistoryPerDevice) {
+        ledger.pop_front();
+    }
+}
+
+bool ActionSimulator::GetDeviceActionHistory(const std::string& device_id,
+                                             int64_t start_secs,
+                                             int64_t end_secs,
+                                             size_t limit,
+                                             google::protobuf::RepeatedPtrField<ActionHistoryRecord>* out) {
+    if (limit == 0) {
+        limit = kDefaultHistoryLimit;
+    }
+
+    std::lock_guard<std::mutex> lock(history_mutex_);
+
+    auto it = history_.find(device_id);
+    if (it == history_.end()) {
+        return false;
+    }
+
+    // the ledger is appended in completion order, so the newest-first
+    // walk stops as soon as records predate the requested range
+    const std::deque<HistoryRecord>& ledger = it->second;
+    for (auto record = ledger.rbegin(); record != ledger.rend(); ++record) {
+        if (start_secs > 0 && record->completed_at < start_secs) {
+            break;
+        }
+        if (end_secs > 0 && record->completed_at > end_secs) {
+            continue;
+        }
+        if (static_cast<size_t>(out->size()) >= limit) {
+            break;
+        }
+
+        ActionHistoryRecord* entry = out->Add();
+        entry->set_action_id(FormatActionId(record->action_id));
+        entry->set_action_type(record->action_type);
+        entry->set_status(record->status);
+        entry->set_initiated_at(record->initiated_at);
+        entry->set_completed_at(record->completed_at);
+    }
+
+    return true;
+}
+
+void ActionSimulator::ScheduleTick(uint64_t action_id,
+                                   std::chrono::steady_clock::time_point due) {
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        timer_queue_.push(TimerEntry{due, action_id});
+    }
+    timer_cv_.notify_one();
+}
+
+void ActionSimulator::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(timer_mutex_);
+
+    while (!shutdown_requested_) {
+        if (timer_queue_.empty()) {
+            timer_cv_.wait(lock);
+            continue;
         }
+
+        auto due = timer_queue_.top().due;
+        if (due > std::chrono::steady_clock::now()) {
+            // sleep until the earliest entry is due or a new one arrives
+            timer_cv_.wait_until(lock, due);
+            continue;
+        }
+
+        uint64_t action_id = timer_queue_.top().action_id;
+        timer_queue_.pop();
+
+        lock.unlock();
+        ProcessActionTick(action_id);
+        lock.lock();
     }
-    
-    std::uniform_int_distribution<> success_dis(1, 100);
-    bool success = (success_dis(gen) <= 90);
-    
+}
+
+void ActionSimulator::ProcessActionTick(uint64_t action_id) {
+    std::string device_id;
+    std::function<void(uint64_t, ActionStatus)> status_callback;
+    bool finished = false;
+    bool cancelled = false;
+    bool success = false;
+
+    bool has_next = false;
+    uint64_t next_action_id = 0;
+    ActionType next_action_type = ActionType::ACTION_TYPE_UNKNOWN;
+    std::function<void(uint64_t, ActionStatus)> next_callback;
+
+    static thread_local std::mt19937 gen(std::random_device{}());
+
     {
         std::lock_guard<std::mutex> lock(actions_mutex_);
         auto it = actions_.find(action_id);
-        if (it != actions_.end()) {
-            if (should_stop || shutdown_requested_) {
-                it->second->status = ActionStatus::FAILED;
-                it->second->error_message = "Action was cancelled";
-            } else if (success) {
-                it->second->status = ActionStatus::COMPLETED;
+        if (it == actions_.end()) {
+            return;
+        }
+
+        ActionData& action = *it->second;
+        if (action.status.load(std::memory_order_relaxed) != ActionStatus::RUNNING) {
+            return;
+        }
+
+        action.elapsed_ticks++;
+
+        auto now_secs = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        // terminal fields are written before the status release-store so
+        // lock-free readers observing the terminal status see them settled
+        if (action.should_stop || shutdown_requested_) {
+            cancelled = true;
+            action.error_message = "Action was cancelled";
+            action.completed_at_secs.store(now_secs, std::memory_order_relaxed);
+            action.status.store(ActionStatus::FAILED, std::memory_order_release);
+        } else if (action.elapsed_ticks >= action.duration_seconds) {
+            finished = true;
+            std::uniform_int_distribution<> success_dis(1, 100);
+            success = (success_dis(gen) <= 90);
+
+            action.completed_at_secs.store(now_secs, std::memory_order_relaxed);
+            if (success) {
+                action.status.store(ActionStatus::COMPLETED, std::memory_order_release);
             } else {
-                it->second->status = ActionStatus::FAILED;
-                it->second->error_message = "Action simulation failed (random failure)";
+                action.error_message = "Action simulation failed (random failure)";
+                action.status.store(ActionStatus::FAILED, std::memory_order_release);
+            }
+        }
+
+        if (finished || cancelled) {
+            device_id = action.device_id;
+            status_callback = action.status_callback;
+            RecordCompletionLocked(finished && success);
+            AppendHistory(action);
+            RetireActionLocked(action_id);
+            active_actions_.erase(device_id);
+
+            // promote the next queued action for this device, if any;
+            // its device-facing start runs below, outside the lock.
+            // a cancellation releases the device just like a completion,
+            // except at shutdown where the sweep drains the queues itself
+            if (finished || (cancelled && !shutdown_requested_)) {
+                auto queue_it = device_queues_.find(device_id);
+                if (queue_it != device_queues_.end() && !queue_it->second.empty()) {
+                    next_action_id = queue_it->second.front();
+                    queue_it->second.pop_front();
+                    if (queue_it->second.empty()) {
+                        device_queues_.erase(queue_it);
+                    }
+                    auto next_it = actions_.find(next_action_id);
+                    if (next_it != actions_.end()) {
+                        ActivateActionLocked(*next_it->second);
+                        next_action_type = next_it->second->action_type;
+                        next_callback = next_it->second->status_callback;
+                        has_next = true;
+                    }
+                }
             }
-            it->second->completed_at = std::chrono::system_clock::now();
         }
     }
-    
-    if (!should_stop && !shutdown_requested_) {
-        DeviceStatus new_device_status = success ? DeviceStatus::IDLE : DeviceStatus::ERROR;
+
+    if (!finished && !cancelled) {
+        ScheduleTick(action_id, std::chrono::steady_clock::now() + std::chrono::seconds(1));
+        return;
+    }
+
+    live_action_count_.fetch_sub(1, std::memory_order_relaxed);
+
+    if (finished || (cancelled && !shutdown_requested_)) {
+        // a cancelled action leaves the device IDLE, not ERROR: the
+        // device did nothing wrong, the rollout was aborted
+        DeviceStatus new_device_status =
+            (finished && !success) ? DeviceStatus::ERROR : DeviceStatus::IDLE;
         device_manager_->SetDeviceStatus(device_id, new_device_status);
-        
+
         device_manager_->ClearDeviceAction(device_id);
     }
-    
+
     if (status_callback) {
-        ActionStatus final_status = should_stop ? ActionStatus::FAILED : 
-                                   (success ? ActionStatus::COMPLETED : ActionStatus::FAILED);
+        ActionStatus final_status = (finished && success) ? ActionStatus::COMPLETED : ActionStatus::FAILED;
         status_callback(action_id, final_status);
     }
+
+    if (has_next) {
+        StartAction(next_action_id, device_id, next_action_type, next_callback);
+    }
 }
 
-std::string ActionSimulator::GenerateActionId() {
+uint64_t ActionSimulator::GenerateActionId() {
+    // millisecond timestamp in the high bits, wrapping counter in the low
+    // bits: ids stay unique as long as fewer than 2^20 actions start per
+    // coarse-clock tick, and no allocation, formatting, or clock syscall
+    // happens here
     uint64_t counter = action_id_counter_.fetch_add(1);
-    auto now = std::chrono::system_clock::now();
-    auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+    auto now = CoarseClock::Now();
+    uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()).count();
-    
+
+    return (timestamp << kActionCounterBits) |
+           (counter & ((1ull << kActionCounterBits) - 1));
+}
+
+std::string ActionSimulator::FormatActionId(uint64_t action_id) {
+    uint64_t timestamp = action_id >> kActionCounterBits;
+    uint64_t counter = action_id & ((1ull << kActionCounterBits) - 1);
+
     std::ostringstream oss;
     oss << "action_" << timestamp << "_" << counter;
     return oss.str();
 }
 
+bool ActionSimulator::ParseActionId(const std::string& text, uint64_t* action_id) {
+    static const std::string kPrefix = "action_";
+    if (text.compare(0, kPrefix.size(), kPrefix) != 0) {
+        return false;
+    }
+
+    size_t separator = text.find('_', kPrefix.size());
+    if (separator == std::string::npos) {
+        return false;
+    }
+
+    try {
+        uint64_t timestamp = std::stoull(text.substr(kPrefix.size(), separator - kPrefix.size()));
+        uint64_t counter = std::stoull(text.substr(separator + 1));
+        if (counter >= (1ull << kActionCounterBits)) {
+            return false;
+        }
+        *action_id = (timestamp << kActionCounterBits) | counter;
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    return true;
+}
+
 }
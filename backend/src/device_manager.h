@@ -2,99 +2,536 @@
 #define DEVICE_MANAGER_H
 
 #include <string>
+#include <array>
+#include <deque>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
 #include <chrono>
 #include <atomic>
 #include <thread>
 #include <functional>
+#include <queue>
 
 #include "device_management.pb.h"
 #include "device_management.grpc.pb.h"
+#include "string_pool.h"
 
 namespace device_management {
 
+class ChangeJournal;
+class DeviceEventBus;
 
 
 class DeviceManager {
 public:
-    // owns in‑memory state for all devices, one instance per server
-    DeviceManager();
+    // default number of independently locked device partitions
+    static constexpr size_t kDefaultShardCount = 16;
+
+    // owns in‑memory state for all devices, one instance per server;
+    // state is partitioned into shard_count independently locked shards
+    // keyed by a hash of device_id so unrelated devices never contend
+    explicit DeviceManager(size_t shard_count = kDefaultShardCount);
     ~DeviceManager();
 
-    bool RegisterDevice(const std::string& device_id, 
+    // one entry of a batched registration
+    struct RegistrationEntry {
+        std::string device_id;
+        std::string device_name;
+        std::string device_type;
+        DeviceStatus initial_status;
+    };
+
+    // one entry of a batched status update
+    struct StatusUpdateEntry {
+        std::string device_id;
+        DeviceStatus status;
+    };
+
+    // full persisted state of one device, used by snapshot save/restore
+    struct DeviceRecord {
+        std::string device_id;
+        std::string device_name;
+        std::string device_type;
+        DeviceStatus status;
+        int64_t registered_at;   // seconds since epoch
+        int64_t last_updated;    // seconds since epoch
+    };
+
+    bool RegisterDevice(const std::string& device_id,
                        const std::string& device_name,
                        const std::string& device_type,
                        DeviceStatus initial_status);
 
+    // registers a whole batch with one lock acquisition per touched shard;
+    // the result vector parallels the input (false = id already registered)
+    std::vector<bool> RegisterDevices(const std::vector<RegistrationEntry>& entries);
+
     bool SetDeviceStatus(const std::string& device_id, DeviceStatus status, DeviceStatus* previous_status = nullptr);
 
+    // applies a whole batch of status updates, one lock acquisition per
+    // touched shard (false = device not found)
+    std::vector<bool> SetDeviceStatusBatch(const std::vector<StatusUpdateEntry>& updates);
+
     std::unique_ptr<DeviceInfo> GetDeviceInfo(const std::string& device_id);
 
+    // fill-in-place overload for the hot path: writes straight into out
+    // (typically the response message) with no intermediate allocation or
+    // copy; returns false when the device does not exist
+    bool GetDeviceInfo(const std::string& device_id, DeviceInfo* out);
+
     std::vector<DeviceInfo> ListAllDevices();
 
+    // appends one page of devices matching the filters straight into out
+    // (typically the response's repeated field), so no intermediate
+    // messages are allocated or copied. pass DEVICE_STATUS_UNKNOWN / an
+    // empty type to leave a dimension unfiltered. page_offset counts
+    // matching devices to skip, and *has_more is set when further
+    // matches exist beyond this page
+    void ListDevices(DeviceStatus status_filter,
+                     const std::string& device_type_filter,
+                     size_t page_size,
+                     uint64_t page_offset,
+                     bool* has_more,
+                     google::protobuf::RepeatedPtrField<DeviceInfo>* out);
+
+    // appends every device matching the filters, unpaged; answered from
+    // the per-shard secondary indexes so cost is proportional to the
+    // result size, not the fleet size
+    void QueryDevices(DeviceStatus status_filter,
+                      const std::string& device_type_filter,
+                      google::protobuf::RepeatedPtrField<DeviceInfo>* out);
+
+    // walks the whole fleet chunk by chunk, invoking emit with at most
+    // chunk_size devices at a time; the shard lock is held only while one
+    // chunk is copied, never across emit. emit returns false to stop early
+    void StreamDevices(size_t chunk_size,
+                       const std::function<bool(std::vector<DeviceInfo>&)>& emit);
+
     bool SetDeviceAction(const std::string& device_id, const std::string& action_id);
 
     bool ClearDeviceAction(const std::string& device_id);
 
     bool DeviceExists(const std::string& device_id);
 
+    size_t DeviceCount();
+
+    // O(1) snapshots of the incrementally maintained fleet aggregates
+    std::array<uint64_t, 8> StatusCounts() const;
+    std::vector<std::pair<std::string, uint64_t>> TypeCounts();
+
+    // dumps every device as a DeviceRecord, shard by shard (snapshot writer)
+    std::vector<DeviceRecord> ExportDevices();
+
+    // walks the fleet invoking emit with at most chunk_size records at a
+    // time; each shard is copied under one shared lock and emit runs with
+    // no lock held, so memory and lock hold time are bounded by a shard
+    // regardless of fleet size. emit returns false to stop early
+    void ExportDevicesChunked(size_t chunk_size,
+                              const std::function<bool(std::vector<DeviceRecord>&)>& emit);
+
+    // reinserts devices from a snapshot or migration, preserving their
+    // original timestamps; existing entries with the same id are left
+    // untouched. returns how many records were actually inserted
+    size_t RestoreDevices(const std::vector<DeviceRecord>& records);
+
+    // applies a journaled status change only when its timestamp is at
+    // least as recent as the device's last update, so replaying a stale
+    // journal never regresses newer state
+    bool RestoreDeviceStatus(const std::string& device_id, DeviceStatus status,
+                             int64_t last_updated);
+
+    // once attached, every successful mutation appends a journal record;
+    // restore/replay paths never journal
+    void AttachJournal(ChangeJournal* journal);
+
+    // once attached, status and action changes publish a DeviceInfo delta
+    // to the bus so watchers get pushed updates instead of polling
+    void AttachEventBus(DeviceEventBus* event_bus);
+
+    // outcome of CreateGroup; the service layer maps each value to its
+    // gRPC status code instead of parsing error prose
+    enum class CreateGroupResult {
+        kCreated,
+        kAlreadyExists,
+        kParentNotFound,
+    };
+
+    // creates a group under parent_group_id (empty = root)
+    CreateGroupResult CreateGroup(const std::string& group_id,
+                                  const std::string& parent_group_id);
+
+    // moves the device into the group (a device belongs to at most one
+    // group); false with *error set when either id is unknown
+    bool AssignDeviceToGroup(const std::string& device_id,
+                             const std::string& group_id,
+                             std::string* error);
+
+    // collects the device ids of the group and all descendant groups;
+    // false when the group is unknown. cost is proportional to the
+    // subtree size, never the fleet
+    bool GroupDeviceIds(const std::string& group_id,
+                        std::vector<std::string>* out);
+
+    // sets every device in the group subtree to the given status with
+    // one exclusive lock acquisition per touched shard; false when the
+    // group is unknown, *updated counts devices actually changed
+    bool SetGroupStatus(const std::string& group_id, DeviceStatus status,
+                        size_t* updated);
+
+    // appends one page of the group subtree's devices into out, ordered
+    // by device id so paging is stable; false when the group is unknown
+    bool ListGroupDevices(const std::string& group_id,
+                          size_t page_size,
+                          uint64_t page_offset,
+                          bool* has_more,
+                          google::protobuf::RepeatedPtrField<DeviceInfo>* out);
+
+    // starts the background liveness monitor: devices whose last_updated
+    // is older than ttl_seconds are transitioned to OFFLINE. expiry is
+    // driven by per-shard touch logs appended on each update, so a sweep
+    // costs O(entries expired) instead of a full map scan, and the
+    // transitions journal and publish like any other status change
+    void StartLivenessMonitor(int ttl_seconds);
+
+    void StopLivenessMonitor();
+
 private:
+    // cold per-device fields; device_type points into the interning pool
+    // and the hot fields (status, last_updated) live in the owning
+    // shard's columns, indexed by slot
     struct DeviceData {
         std::string device_id;
         std::string device_name;
-        std::string device_type;
-        DeviceStatus status;
+        const std::string* device_type;
+        size_t slot;
         std::chrono::system_clock::time_point registered_at;
-        std::chrono::system_clock::time_point last_updated;
         std::string current_action_id;
     };
 
-    std::unordered_map<std::string, DeviceData> devices_;
-    std::mutex devices_mutex_;
+    // one independently locked partition of the device map; the status
+    // and type indexes are kept in sync with the devices map so filtered
+    // listings never scan unrelated entries. reads take the shard lock
+    // shared so concurrent readers never queue behind each other.
+    // status and last_updated are struct-of-arrays columns indexed by
+    // DeviceData::slot, so scans touch contiguous memory instead of
+    // chasing pointers through the map
+    struct Shard {
+        std::unordered_map<std::string, DeviceData> devices;
+        std::vector<DeviceStatus> status;
+        std::vector<std::chrono::system_clock::time_point> last_updated;
+        std::unordered_map<int, std::unordered_set<std::string>> by_status;
+        std::unordered_map<std::string, std::unordered_set<std::string>> by_type;
+
+        // time-ordered log of (touch time, device) appended by every
+        // mutation while the liveness monitor runs; entries are popped
+        // lazily once older than the TTL and re-checked against the
+        // last_updated column, so a device that kept heartbeating just
+        // drops its stale entries without any work per heartbeat
+        std::deque<std::pair<std::chrono::system_clock::time_point, std::string>> touch_log;
+
+        std::shared_mutex mutex;
+    };
+
+    // one node of the group hierarchy; membership is a plain id set so
+    // group-scoped operations enumerate exactly the member devices
+    struct Group {
+        std::string parent_id;
+        std::vector<std::string> children;
+        std::unordered_set<std::string> devices;
+    };
+
+    size_t ShardIndexFor(const std::string& device_id) const;
+
+    Shard& ShardFor(const std::string& device_id);
+
+    // single-entry bodies shared by the one-shot and batched paths;
+    // callers must hold the shard lock exclusively
+    bool RegisterDeviceLocked(Shard& shard, const RegistrationEntry& entry);
+    bool SetDeviceStatusLocked(Shard& shard, const std::string& device_id,
+                               DeviceStatus status, DeviceStatus* previous_status);
+
+    static void FillDeviceInfo(const Shard& shard, const DeviceData& device, DeviceInfo* device_info);
+
+    // builds the delta and hands it to the bus; no-op when no bus attached
+    void PublishDeviceEvent(const Shard& shard, const DeviceData& device);
+
+    // records a touch in the shard's log when the monitor is running;
+    // caller must hold the shard lock exclusively
+    void TouchLocked(Shard& shard, const std::string& device_id,
+                     std::chrono::system_clock::time_point when);
+
+    // one pass over all shards expiring stale devices to OFFLINE
+    void SweepStaleDevices(std::chrono::seconds ttl);
+
+    void LivenessLoop(int ttl_seconds);
+
+    // walks the subtree rooted at group collecting member device ids;
+    // caller must hold groups_mutex_ at least shared
+    void CollectGroupDevicesLocked(const Group& group,
+                                   std::vector<std::string>* out) const;
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    StringPool type_pool_;
+
+    // the group hierarchy is tiny next to the fleet and mutates rarely,
+    // so one shared_mutex over all of it is enough; never held while a
+    // shard lock is taken, so there is no ordering with shard mutexes
+    std::unordered_map<std::string, Group> groups_;
+    std::unordered_map<std::string, std::string> device_group_;
+    std::shared_mutex groups_mutex_;
+
+    ChangeJournal* journal_;
+    DeviceEventBus* event_bus_;
+
+    // fleet-wide aggregates maintained by the mutators: one relaxed
+    // atomic per status (types never change after registration, so the
+    // type map only mutates under its own mutex at registration time)
+    std::atomic<uint64_t> device_count_{0};
+    std::array<std::atomic<uint64_t>, 8> status_counts_{};
+    std::unordered_map<std::string, uint64_t> type_counts_;
+    std::mutex type_counts_mutex_;
+
+    std::atomic<bool> liveness_enabled_{false};
+    bool liveness_running_ = false;
+    std::thread liveness_thread_;
+    std::mutex liveness_mutex_;
+    std::condition_variable liveness_cv_;
 };
 
 class ActionSimulator {
 public:
-    // runs long‑lived actions on a background thread and reports progress
-    ActionSimulator(DeviceManager* device_manager);
+    // default number of worker threads advancing pending actions
+    static constexpr size_t kDefaultWorkerCount = 4;
+
+    // default number of finished actions kept for status lookups
+    static constexpr size_t kDefaultRetiredCapacity = 100000;
+
+    // most actions a single device may have waiting behind its current one
+    static constexpr size_t kMaxQueuedPerDevice = 8;
+
+    // finished actions remembered per device in the history ledger
+    static constexpr size_t kMaxHistoryPerDevice = 1024;
+
+    // records returned by a history query that leaves the limit unset
+    static constexpr size_t kDefaultHistoryLimit = 100;
+
+    // runs long‑lived actions and reports progress; pending actions live
+    // in a timer queue and a small fixed pool of workers advances them,
+    // so each in‑flight action costs an entry instead of an OS thread.
+    // finished actions are retired into a fixed-capacity ring buffer of
+    // compact records, so actions_ only ever holds live work
+    explicit ActionSimulator(DeviceManager* device_manager,
+                             size_t worker_count = kDefaultWorkerCount,
+                             size_t retired_capacity = kDefaultRetiredCapacity);
     ~ActionSimulator();
 
-    std::string InitiateAction(const std::string& device_id,
-                               ActionType action_type,
-                               const std::map<std::string, std::string>& action_params,
-                               std::function<void(const std::string&, ActionStatus)> status_callback);
+    // actions are identified internally by a packed uint64 (millisecond
+    // timestamp in the high bits, a wrapping counter in the low bits);
+    // the "action_<timestamp>_<counter>" wire form is produced and parsed
+    // only at the protobuf boundary.
+    // a busy device queues the action instead of rejecting it: it starts
+    // automatically when the device's current action finishes, and
+    // *queue_position reports how many actions are ahead of it (0 =
+    // started immediately). returns 0 when the device's queue is full
+    uint64_t InitiateAction(const std::string& device_id,
+                            ActionType action_type,
+                            const std::map<std::string, std::string>& action_params,
+                            std::function<void(uint64_t, ActionStatus)> status_callback,
+                            int* queue_position = nullptr);
+
+    // outcome of CancelAction; the service layer maps each value to its
+    // gRPC status code instead of parsing error prose
+    enum class CancelResult {
+        kCancelled,
+        kNotFound,
+        kAlreadyFinished,
+    };
+
+    // aborts one action: a queued (or not-yet-started) action is
+    // finalized as FAILED right here, and a running one has its stop
+    // flag set and an immediate tick scheduled so the worker honors the
+    // cancellation within milliseconds instead of at the next one-second
+    // tick
+    CancelResult CancelAction(uint64_t action_id);
 
-    std::unique_ptr<ActionInfo> GetActionStatus(const std::string& action_id);
+    std::unique_ptr<ActionInfo> GetActionStatus(uint64_t action_id);
+
+    // fill-in-place overload for the status-poll hot path; returns false
+    // when the action is unknown
+    bool GetActionStatus(uint64_t action_id, ActionInfo* out);
+
+    // renders an id into its "action_<timestamp>_<counter>" wire form
+    static std::string FormatActionId(uint64_t action_id);
+
+    // parses the wire form back into a packed id; false when malformed
+    static bool ParseActionId(const std::string& text, uint64_t* action_id);
+
+    // actions currently pending or running
+    size_t LiveActionCount() const;
+
+    // all actions tracked since startup
+    size_t TotalActionCount();
+
+    // completions/failures recorded within the past hour, from the
+    // per-minute buckets maintained on the completion path
+    void CompletionCountsLastHour(uint64_t* completed, uint64_t* failed);
+
+    // appends up to limit records of the device's finished actions,
+    // newest first, restricted to completed_at in [start_secs, end_secs]
+    // (0 = unbounded); the ledger outlives action retirement, so this
+    // answers "what ran on device X last week" without touching actions_.
+    // returns false when the device has no recorded history
+    bool GetDeviceActionHistory(const std::string& device_id,
+                                int64_t start_secs,
+                                int64_t end_secs,
+                                size_t limit,
+                                google::protobuf::RepeatedPtrField<ActionHistoryRecord>* out);
 
     void Shutdown();
 
 private:
+    // low bits of a packed action id reserved for the per-process counter
+    static constexpr int kActionCounterBits = 20;
+
+    // status and completed_at are atomics so status polls read them
+    // wait-free without touching actions_mutex_: writers publish a
+    // terminal state by writing error_message/completed_at first and
+    // storing status last with release ordering, and readers that
+    // observe a terminal status with acquire ordering may then read
+    // error_message safely (it is never written again). the remaining
+    // fields are immutable after creation or only touched by the single
+    // worker advancing the action
     struct ActionData {
-        std::string action_id;
+        uint64_t action_id;
         std::string device_id;
         ActionType action_type;
-        ActionStatus status;
+        std::atomic<ActionStatus> status;
         std::map<std::string, std::string> action_params;
         std::chrono::system_clock::time_point initiated_at;
-        std::chrono::system_clock::time_point completed_at;
+        std::atomic<int64_t> completed_at_secs{0};
         std::string error_message;
-        std::thread simulation_thread;
+        std::function<void(uint64_t, ActionStatus)> status_callback;
+        int duration_seconds;
+        int elapsed_ticks;
         std::atomic<bool> should_stop;
     };
 
-    void SimulateAction(const std::string& action_id, 
-                       const std::string& device_id,
-                       ActionType action_type,
-                       std::function<void(const std::string&, ActionStatus)> status_callback);
+    // fixed-size ledger entry appended when an action reaches a terminal
+    // state; timestamps are whole seconds, matching what the API exposes
+    struct HistoryRecord {
+        uint64_t action_id;
+        ActionType action_type;
+        ActionStatus status;
+        int64_t initiated_at;
+        int64_t completed_at;
+    };
+
+    // compact record kept after an action finishes; the param map and
+    // completion callback of the full ActionData are reclaimed on retirement
+    struct RetiredAction {
+        uint64_t action_id;
+        std::string device_id;
+        ActionType action_type;
+        ActionStatus status;
+        std::chrono::system_clock::time_point initiated_at;
+        std::chrono::system_clock::time_point completed_at;
+        std::string error_message;
+    };
+
+    // one scheduled wake-up for an action, ordered by due time
+    struct TimerEntry {
+        std::chrono::steady_clock::time_point due;
+        uint64_t action_id;
+
+        bool operator>(const TimerEntry& other) const {
+            return due > other.due;
+        }
+    };
+
+    void WorkerLoop();
+
+    void ProcessActionTick(uint64_t action_id);
+
+    void ScheduleTick(uint64_t action_id,
+                      std::chrono::steady_clock::time_point due);
 
-    std::string GenerateActionId();
+    uint64_t GenerateActionId();
+
+    // moves a finished action into the retirement ring; caller must hold
+    // actions_mutex_
+    void RetireActionLocked(uint64_t action_id);
+
+    // bumps the current minute's completion bucket; caller must hold
+    // actions_mutex_
+    void RecordCompletionLocked(bool success);
+
+    // appends the action's terminal record to its device's ledger; takes
+    // history_mutex_ itself (safe under actions_mutex_: the history lock
+    // is always innermost)
+    void AppendHistory(const ActionData& action);
+
+    // marks the action RUNNING and records it as the device's active one;
+    // caller must hold actions_mutex_ and then call StartAction outside it
+    void ActivateActionLocked(ActionData& action);
+
+    // device-facing side effects of starting an action (device record,
+    // device status, initial callback); must run without actions_mutex_
+    void StartAction(uint64_t action_id, const std::string& device_id,
+                     ActionType action_type,
+                     const std::function<void(uint64_t, ActionStatus)>& status_callback);
+
+    // shared_ptr values keep an action alive for lock-free readers that
+    // grabbed it just before retirement erased it from the map; the
+    // mutex guards only the map structure, queues, and retirement ring
+    std::unordered_map<uint64_t, std::shared_ptr<ActionData>> actions_;
+
+    // per-device scheduling state: the action currently holding each
+    // device plus the bounded queue waiting behind it, all guarded by
+    // actions_mutex_
+    std::unordered_map<std::string, uint64_t> active_actions_;
+    std::unordered_map<std::string, std::deque<uint64_t>> device_queues_;
 
-    std::unordered_map<std::string, std::unique_ptr<ActionData>> actions_;
     std::mutex actions_mutex_;
+
+    // one slot per minute of the trailing hour; a slot is reset when a
+    // completion lands in a new minute, and reads skip slots whose tag
+    // fell out of the window. guarded by actions_mutex_
+    struct CompletionBucket {
+        int64_t minute = -1;
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+    };
+    std::array<CompletionBucket, 60> completion_buckets_;
+
+    // fixed-capacity ring of retired actions plus an id -> slot index,
+    // both guarded by actions_mutex_; the oldest entry is overwritten
+    // once the ring is full
+    std::vector<RetiredAction> retired_ring_;
+    std::unordered_map<uint64_t, size_t> retired_index_;
+    size_t retired_capacity_;
+    size_t retired_next_;
+
+    // per-device append-only ledgers of terminal records, oldest dropped
+    // past kMaxHistoryPerDevice; appends keep completed_at order, so a
+    // time-range query walks a contiguous recent span instead of
+    // scanning a hash map. guarded by history_mutex_ (innermost lock)
+    std::unordered_map<std::string, std::deque<HistoryRecord>> history_;
+    std::mutex history_mutex_;
+
+    std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> timer_queue_;
+    std::mutex timer_mutex_;
+    std::condition_variable timer_cv_;
+    std::vector<std::thread> workers_;
+
     DeviceManager* device_manager_;
     std::atomic<uint64_t> action_id_counter_;
+    std::atomic<size_t> live_action_count_;
+    std::atomic<uint64_t> total_action_count_;
     std::atomic<bool> shutdown_requested_;
 };
 
@@ -0,0 +1,53 @@
+#include "event_bus.h"
+#include <algorithm>
+
+namespace device_management {
+
+bool DeviceEventBus::Subscription::Next(DeviceInfo* event, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!cv_.wait_for(lock, timeout, [this]() { return !queue_.empty(); })) {
+        return false;
+    }
+    *event = std::move(queue_.front());
+    queue_.pop_front();
+    return true;
+}
+
+std::shared_ptr<DeviceEventBus::Subscription> DeviceEventBus::Subscribe(size_t queue_capacity) {
+    if (queue_capacity == 0) {
+        queue_capacity = 1;
+    }
+    auto subscription = std::make_shared<Subscription>(queue_capacity);
+
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    subscribers_.push_back(subscription);
+    subscriber_count_.store(subscribers_.size(), std::memory_order_relaxed);
+    return subscription;
+}
+
+void DeviceEventBus::Unsubscribe(const std::shared_ptr<Subscription>& subscription) {
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    subscribers_.erase(
+        std::remove(subscribers_.begin(), subscribers_.end(), subscription),
+        subscribers_.end());
+    subscriber_count_.store(subscribers_.size(), std::memory_order_relaxed);
+}
+
+void DeviceEventBus::Publish(const DeviceInfo& event) {
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+
+    for (auto& subscription : subscribers_) {
+        {
+            std::lock_guard<std::mutex> queue_lock(subscription->mutex_);
+            if (subscription->queue_.size() >= subscription->capacity_) {
+                // never let a slow subscriber back up the mutator
+                subscription->dropped_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            subscription->queue_.push_back(event);
+        }
+        subscription->cv_.notify_one();
+    }
+}
+
+}
@@ -0,0 +1,64 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "device_management.pb.h"
+
+namespace device_management {
+
+// fans device state changes out to stream subscribers. publishers push a
+// DeviceInfo delta into every subscriber's bounded queue; a slow
+// subscriber drops events (counted) instead of backing up the mutators
+class DeviceEventBus {
+public:
+    // default events buffered per subscriber before drops start
+    static constexpr size_t kDefaultQueueCapacity = 1024;
+
+    class Subscription {
+        friend class DeviceEventBus;
+
+    public:
+        explicit Subscription(size_t capacity) : capacity_(capacity), dropped_(0) {}
+
+        // blocks up to timeout for the next event; false on timeout
+        bool Next(DeviceInfo* event, std::chrono::milliseconds timeout);
+
+        // events discarded because this subscriber's queue was full
+        uint64_t dropped_count() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        std::deque<DeviceInfo> queue_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        size_t capacity_;
+        std::atomic<uint64_t> dropped_;
+    };
+
+    std::shared_ptr<Subscription> Subscribe(size_t queue_capacity = kDefaultQueueCapacity);
+
+    void Unsubscribe(const std::shared_ptr<Subscription>& subscription);
+
+    void Publish(const DeviceInfo& event);
+
+    // relaxed snapshot of whether anyone is listening; publishers use it
+    // to skip building and locking for an event nobody would receive
+    bool HasSubscribers() const {
+        return subscriber_count_.load(std::memory_order_relaxed) > 0;
+    }
+
+private:
+    std::vector<std::shared_ptr<Subscription>> subscribers_;
+    std::mutex subscribers_mutex_;
+    std::atomic<size_t> subscriber_count_{0};
+};
+
+}
+
+#endif
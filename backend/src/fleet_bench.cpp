@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+
+#include "device_manager.h"
+
+using device_management::ActionSimulator;
+using device_management::ActionType;
+using device_management::DeviceManagementService;
+using device_management::DeviceManager;
+using device_management::DeviceStatus;
+
+namespace {
+
+// latencies recorded by one worker, merged after the run so the hot loop
+// never takes a shared lock
+struct WorkerResult {
+    std::vector<uint64_t> latencies_usec;
+    uint64_t heartbeats = 0;
+    uint64_t info_polls = 0;
+    uint64_t actions = 0;
+    uint64_t errors = 0;
+};
+
+std::string ParseTarget(int argc, char** argv) {  //Server address for grpc mode
+    std::string target = "localhost:50051";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--target" && i + 1 < argc) {
+            target = argv[i + 1];
+            break;
+        }
+    }
+
+    return target;
+}
+
+std::string ParseMode(int argc, char** argv) {  //"grpc" drives the server, "local" calls DeviceManager directly
+    std::string mode = "grpc";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--mode" && i + 1 < argc) {
+            mode = argv[i + 1];
+            break;
+        }
+    }
+
+    return mode;
+}
+
+int ParseIntFlag(int argc, char** argv, const std::string& name, int default_value) {
+    int value = default_value;
+
+    for (int i = 1; i < argc; ++i) {
+        if (name == argv[i] && i + 1 < argc) {
+            value = std::stoi(argv[i + 1]);
+            break;
+        }
+    }
+
+    return value;
+}
+
+// weighted op choice: heartbeats dominate real fleets, info polls and
+// action initiations make up the rest
+enum class Op { kHeartbeat, kGetInfo, kInitiateAction };
+
+Op PickOp(std::mt19937& gen, int action_percent) {
+    std::uniform_int_distribution<> dis(1, 100);
+    int roll = dis(gen);
+    if (roll <= action_percent) {
+        return Op::kInitiateAction;
+    }
+    // of the remainder, three quarters are heartbeats
+    if (roll <= action_percent + (100 - action_percent) * 3 / 4) {
+        return Op::kHeartbeat;
+    }
+    return Op::kGetInfo;
+}
+
+DeviceStatus PickStatus(std::mt19937& gen) {
+    static const DeviceStatus kStatuses[] = {
+        DeviceStatus::IDLE, DeviceStatus::BUSY, DeviceStatus::OFFLINE,
+        DeviceStatus::MAINTENANCE, DeviceStatus::RECOVERING,
+    };
+    std::uniform_int_distribution<> dis(0, 4);
+    return kStatuses[dis(gen)];
+}
+
+std::string DeviceIdFor(int index) {
+    return "bench_device_" + std::to_string(index);
+}
+
+void PrintReport(const std::string& label, std::vector<WorkerResult>& results, double seconds) {
+    std::vector<uint64_t> all;
+    uint64_t heartbeats = 0, info_polls = 0, actions = 0, errors = 0;
+    for (auto& result : results) {
+        all.insert(all.end(), result.latencies_usec.begin(), result.latencies_usec.end());
+        heartbeats += result.heartbeats;
+        info_polls += result.info_polls;
+        actions += result.actions;
+        errors += result.errors;
+    }
+    std::sort(all.begin(), all.end());
+
+    auto percentile = [&](double p) -> uint64_t {
+        if (all.empty()) {
+            return 0;
+        }
+        size_t index = static_cast<size_t>(p * (all.size() - 1));
+        return all[index];
+    };
+
+    uint64_t total = all.size();
+    std::cout << "========================================\n";
+    std::cout << label << "\n";
+    std::cout << "  ops:        " << total << " in " << seconds << "s ("
+              << static_cast<uint64_t>(total / seconds) << " ops/s)\n";
+    std::cout << "  heartbeats: " << heartbeats << ", info polls: " << info_polls
+              << ", actions: " << actions << ", errors: " << errors << "\n";
+    std::cout << "  latency:    p50 " << percentile(0.50) << "us, p90 "
+              << percentile(0.90) << "us, p99 " << percentile(0.99) << "us, max "
+              << (all.empty() ? 0 : all.back()) << "us\n";
+    std::cout << "========================================\n";
+}
+
+// drives the server over gRPC with the configured mix; each worker owns
+// its channel so client-side contention does not skew the numbers
+void RunGrpcBench(const std::string& target, int devices, int duration, int threads,
+                  int action_percent) {
+    {
+        // registration happens up front on one connection and is not timed
+        auto channel = grpc::CreateChannel(target, grpc::InsecureChannelCredentials());
+        auto stub = DeviceManagementService::NewStub(channel);
+        for (int i = 0; i < devices; ++i) {
+            device_management::RegisterDeviceRequest request;
+            request.set_device_id(DeviceIdFor(i));
+            request.set_device_name("Bench Device " + std::to_string(i));
+            request.set_device_type("bench");
+            request.set_initial_status(DeviceStatus::IDLE);
+
+            device_management::RegisterDeviceResponse response;
+            grpc::ClientContext context;
+            stub->RegisterDevice(&context, request, &response);
+        }
+    }
+    std::cout << "Registered " << devices << " device(s) against " << target << "\n";
+
+    std::vector<WorkerResult> results(threads);
+    std::vector<std::thread> workers;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(duration);
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            auto channel = grpc::CreateChannel(target, grpc::InsecureChannelCredentials());
+            auto stub = DeviceManagementService::NewStub(channel);
+            std::mt19937 gen(std::random_device{}());
+            std::uniform_int_distribution<> device_dis(0, devices - 1);
+            WorkerResult& result = results[t];
+
+            while (std::chrono::steady_clock::now() < deadline) {
+                std::string device_id = DeviceIdFor(device_dis(gen));
+                Op op = PickOp(gen, action_percent);
+
+                auto start = std::chrono::steady_clock::now();
+                bool ok = false;
+                switch (op) {
+                    case Op::kHeartbeat: {
+                        device_management::SetDeviceStatusRequest request;
+                        request.set_device_id(device_id);
+                        request.set_status(PickStatus(gen));
+                        device_management::SetDeviceStatusResponse response;
+                        grpc::ClientContext context;
+                        ok = stub->SetDeviceStatus(&context, request, &response).ok();
+                        result.heartbeats++;
+                        break;
+                    }
+                    case Op::kGetInfo: {
+                        device_management::GetDeviceInfoRequest request;
+                        request.set_device_id(device_id);
+                        device_management::GetDeviceInfoResponse response;
+                        grpc::ClientContext context;
+                        ok = stub->GetDeviceInfo(&context, request, &response).ok();
+                        result.info_polls++;
+                        break;
+                    }
+                    case Op::kInitiateAction: {
+                        device_management::InitiateDeviceActionRequest request;
+                        request.set_device_id(device_id);
+                        request.set_action_type(ActionType::SYSTEM_REBOOT);
+                        device_management::InitiateDeviceActionResponse response;
+                        grpc::ClientContext context;
+                        // busy devices queue the action, so an error here
+                        // means the device's queue overflowed
+                        // (RESOURCE_EXHAUSTED): the errors column reports
+                        // saturation, not routine contention
+                        ok = stub->InitiateDeviceAction(&context, request, &response).ok();
+                        result.actions++;
+                        break;
+                    }
+                }
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+                result.latencies_usec.push_back(static_cast<uint64_t>(elapsed));
+                if (!ok) {
+                    result.errors++;
+                }
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    PrintReport("fleet_bench grpc mode", results, static_cast<double>(duration));
+}
+
+// same mix straight against DeviceManager/ActionSimulator, no network:
+// comparing against grpc mode separates lock costs from gRPC costs
+void RunLocalBench(int devices, int duration, int threads, int action_percent) {
+    DeviceManager device_manager;
+    ActionSimulator action_simulator(&device_manager);
+
+    for (int i = 0; i < devices; ++i) {
+        device_manager.RegisterDevice(DeviceIdFor(i), "Bench Device " + std::to_string(i),
+                                      "bench", DeviceStatus::IDLE);
+    }
+    std::cout << "Registered " << devices << " device(s) in process\n";
+
+    std::vector<WorkerResult> results(threads);
+    std::vector<std::thread> workers;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(duration);
+
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 gen(std::random_device{}());
+            std::uniform_int_distribution<> device_dis(0, devices - 1);
+            WorkerResult& result = results[t];
+
+            while (std::chrono::steady_clock::now() < deadline) {
+                std::string device_id = DeviceIdFor(device_dis(gen));
+                Op op = PickOp(gen, action_percent);
+
+                auto start = std::chrono::steady_clock::now();
+                bool ok = true;
+                switch (op) {
+                    case Op::kHeartbeat:
+                        ok = device_manager.SetDeviceStatus(device_id, PickStatus(gen));
+                        result.heartbeats++;
+                        break;
+                    case Op::kGetInfo:
+                        ok = device_manager.GetDeviceInfo(device_id) != nullptr;
+                        result.info_polls++;
+                        break;
+                    case Op::kInitiateAction:
+                        action_simulator.InitiateAction(device_id, ActionType::SYSTEM_REBOOT,
+                                                        {}, nullptr);
+                        result.actions++;
+                        break;
+                }
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+                result.latencies_usec.push_back(static_cast<uint64_t>(elapsed));
+                if (!ok) {
+                    result.errors++;
+                }
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    action_simulator.Shutdown();
+
+    PrintReport("fleet_bench local mode", results, static_cast<double>(duration));
+}
+
+}
+
+int main(int argc, char** argv) {
+    try {
+        std::string target = ParseTarget(argc, argv);
+        std::string mode = ParseMode(argc, argv);
+        int devices = ParseIntFlag(argc, argv, "--devices", 1000);
+        int duration = ParseIntFlag(argc, argv, "--duration", 10);
+        int threads = ParseIntFlag(argc, argv, "--threads", 8);
+        int action_percent = ParseIntFlag(argc, argv, "--action-percent", 2);
+
+        if (devices <= 0 || duration <= 0 || threads <= 0) {
+            std::cerr << "Error: --devices, --duration and --threads must be positive\n";
+            return 1;
+        }
+
+        if (mode == "local") {
+            RunLocalBench(devices, duration, threads, action_percent);
+        } else if (mode == "grpc") {
+            RunGrpcBench(target, devices, duration, threads, action_percent);
+        } else {
+            std::cerr << "Error: --mode must be 'grpc' or 'local'\n";
+            return 1;
+        }
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,330 @@
+#include "journal.h"
+#include "device_manager.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace device_management {
+
+// journal record layout: u32 payload length, then u8 opcode followed by
+// the op's fields; strings are u32-length-prefixed. a torn tail record
+// from a crash is detected by the length prefix and ignored on replay
+namespace {
+
+enum JournalOp : uint8_t {
+    kOpRegister = 1,
+    kOpSetStatus = 2,
+    kOpSetAction = 3,
+    kOpClearAction = 4,
+};
+
+void AppendBytes(std::string& out, const void* data, size_t size) {
+    out.append(static_cast<const char*>(data), size);
+}
+
+void AppendString(std::string& out, const std::string& value) {
+    uint32_t length = static_cast<uint32_t>(value.size());
+    AppendBytes(out, &length, sizeof(length));
+    AppendBytes(out, value.data(), value.size());
+}
+
+void FrameRecord(std::string& out, const std::string& payload) {
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    AppendBytes(out, &length, sizeof(length));
+    out.append(payload);
+}
+
+bool ReadBytes(const char*& cursor, const char* end, void* out, size_t size) {
+    if (static_cast<size_t>(end - cursor) < size) {
+        return false;
+    }
+    std::memcpy(out, cursor, size);
+    cursor += size;
+    return true;
+}
+
+bool ReadString(const char*& cursor, const char* end, std::string* out) {
+    uint32_t length = 0;
+    if (!ReadBytes(cursor, end, &length, sizeof(length))) {
+        return false;
+    }
+    if (static_cast<size_t>(end - cursor) < length) {
+        return false;
+    }
+    out->assign(cursor, length);
+    cursor += length;
+    return true;
+}
+
+}
+
+ChangeJournal::ChangeJournal(const std::string& path)
+    : path_(path), rotated_path_(path + ".old"), fd_(-1), stop_requested_(false) {
+}
+
+ChangeJournal::~ChangeJournal() {
+    Stop();
+}
+
+size_t ChangeJournal::Replay(DeviceManager* device_manager) {
+    // a rotated segment left behind by a crash mid-snapshot holds the
+    // older records; replay it first so the live segment's newer
+    // timestamps win the merge
+    return ReplayFile(rotated_path_, device_manager) +
+           ReplayFile(path_, device_manager);
+}
+
+size_t ChangeJournal::ReplayFile(const std::string& path, DeviceManager* device_manager) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return 0;
+    }
+
+    std::string contents((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+    const char* cursor = contents.data();
+    const char* end = cursor + contents.size();
+
+    size_t applied = 0;
+
+    while (cursor < end) {
+        uint32_t length = 0;
+        if (!ReadBytes(cursor, end, &length, sizeof(length)) ||
+            static_cast<size_t>(end - cursor) < length) {
+            // torn tail from a crash mid-write: everything before it is good
+            break;
+        }
+
+        const char* record_end = cursor + length;
+        uint8_t op = 0;
+        if (!ReadBytes(cursor, record_end, &op, sizeof(op))) {
+            break;
+        }
+
+        std::string device_id;
+        bool ok = false;
+
+        switch (op) {
+            case kOpRegister: {
+                DeviceManager::DeviceRecord record;
+                int32_t status = 0;
+                ok = ReadString(cursor, record_end, &record.device_id) &&
+                     ReadString(cursor, record_end, &record.device_name) &&
+                     ReadString(cursor, record_end, &record.device_type) &&
+                     ReadBytes(cursor, record_end, &status, sizeof(status)) &&
+                     ReadBytes(cursor, record_end, &record.registered_at, sizeof(record.registered_at));
+                // a corrupt or tampered file must not feed an arbitrary
+                // int into the per-status counter array
+                if (ok && DeviceStatus_IsValid(status)) {
+                    record.status = static_cast<DeviceStatus>(status);
+                    record.last_updated = record.registered_at;
+                    device_manager->RestoreDevices({record});
+                }
+                break;
+            }
+            case kOpSetStatus: {
+                int32_t status = 0;
+                int64_t timestamp = 0;
+                ok = ReadString(cursor, record_end, &device_id) &&
+                     ReadBytes(cursor, record_end, &status, sizeof(status)) &&
+                     ReadBytes(cursor, record_end, &timestamp, sizeof(timestamp));
+                if (ok && DeviceStatus_IsValid(status)) {
+                    device_manager->RestoreDeviceStatus(device_id, static_cast<DeviceStatus>(status), timestamp);
+                }
+                break;
+            }
+            case kOpSetAction:
+            case kOpClearAction: {
+                // simulated actions do not survive a restart, so action
+                // assignments are replayed as touch-only updates rather
+                // than resurrecting a dangling current_action_id
+                std::string action_id;
+                int64_t timestamp = 0;
+                ok = ReadString(cursor, record_end, &device_id);
+                if (ok && op == kOpSetAction) {
+                    ok = ReadString(cursor, record_end, &action_id);
+                }
+                ok = ok && ReadBytes(cursor, record_end, &timestamp, sizeof(timestamp));
+                break;
+            }
+            default:
+                break;
+        }
+
+        if (!ok) {
+            break;
+        }
+
+        cursor = record_end;
+        applied++;
+    }
+
+    return applied;
+}
+
+bool ChangeJournal::Start(int flush_interval_ms) {
+    if (fd_ >= 0) {
+        return true;
+    }
+
+    fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    if (flush_interval_ms <= 0) {
+        flush_interval_ms = kDefaultFlushIntervalMs;
+    }
+    flush_thread_ = std::thread([this, flush_interval_ms]() {
+        FlushLoop(flush_interval_ms);
+    });
+
+    return true;
+}
+
+void ChangeJournal::Stop() {
+    if (flush_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex_);
+            stop_requested_ = true;
+        }
+        stop_cv_.notify_all();
+        flush_thread_.join();
+    }
+
+    if (fd_ >= 0) {
+        FlushPending();
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+void ChangeJournal::Rotate() {
+    if (fd_ < 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> io_lock(io_mutex_);
+    FlushPendingLocked();
+
+    // append to the rotated segment rather than renaming over it, so a
+    // segment left over from a failed snapshot keeps its records in order
+    std::ifstream live(path_, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(live)),
+                         std::istreambuf_iterator<char>());
+    if (!contents.empty()) {
+        std::ofstream rotated(rotated_path_, std::ios::binary | std::ios::app);
+        if (!rotated) {
+            return;
+        }
+        rotated.write(contents.data(), contents.size());
+        if (!rotated) {
+            return;
+        }
+    }
+
+    // a crash between the copy and this truncate duplicates records
+    // across the two segments, which the timestamp merge absorbs
+    if (ftruncate(fd_, 0) != 0) {
+        return;
+    }
+}
+
+void ChangeJournal::DropRotated() {
+    std::remove(rotated_path_.c_str());
+}
+
+void ChangeJournal::AppendRegister(const std::string& device_id, const std::string& device_name,
+                                   const std::string& device_type, int32_t status, int64_t timestamp) {
+    std::string payload;
+    payload.push_back(static_cast<char>(kOpRegister));
+    AppendString(payload, device_id);
+    AppendString(payload, device_name);
+    AppendString(payload, device_type);
+    AppendBytes(payload, &status, sizeof(status));
+    AppendBytes(payload, &timestamp, sizeof(timestamp));
+    Append(payload);
+}
+
+void ChangeJournal::AppendStatus(const std::string& device_id, int32_t status, int64_t timestamp) {
+    std::string payload;
+    payload.push_back(static_cast<char>(kOpSetStatus));
+    AppendString(payload, device_id);
+    AppendBytes(payload, &status, sizeof(status));
+    AppendBytes(payload, &timestamp, sizeof(timestamp));
+    Append(payload);
+}
+
+void ChangeJournal::AppendSetAction(const std::string& device_id, const std::string& action_id,
+                                    int64_t timestamp) {
+    std::string payload;
+    payload.push_back(static_cast<char>(kOpSetAction));
+    AppendString(payload, device_id);
+    AppendString(payload, action_id);
+    AppendBytes(payload, &timestamp, sizeof(timestamp));
+    Append(payload);
+}
+
+void ChangeJournal::AppendClearAction(const std::string& device_id, int64_t timestamp) {
+    std::string payload;
+    payload.push_back(static_cast<char>(kOpClearAction));
+    AppendString(payload, device_id);
+    AppendBytes(payload, &timestamp, sizeof(timestamp));
+    Append(payload);
+}
+
+void ChangeJournal::Append(const std::string& record) {
+    if (fd_ < 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    FrameRecord(pending_, record);
+}
+
+void ChangeJournal::FlushLoop(int flush_interval_ms) {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    while (!stop_requested_) {
+        if (stop_cv_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms),
+                              [this]() { return stop_requested_.load(); })) {
+            break;
+        }
+        lock.unlock();
+        FlushPending();
+        lock.lock();
+    }
+}
+
+void ChangeJournal::FlushPending() {
+    std::lock_guard<std::mutex> io_lock(io_mutex_);
+    FlushPendingLocked();
+}
+
+void ChangeJournal::FlushPendingLocked() {
+    std::string batch;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        batch.swap(pending_);
+    }
+
+    if (batch.empty() || fd_ < 0) {
+        return;
+    }
+
+    size_t written = 0;
+    while (written < batch.size()) {
+        ssize_t n = write(fd_, batch.data() + written, batch.size() - written);
+        if (n <= 0) {
+            return;
+        }
+        written += static_cast<size_t>(n);
+    }
+    fsync(fd_);
+}
+
+}
@@ -0,0 +1,90 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace device_management {
+
+class DeviceManager;
+
+// append-only binary change journal covering the interval between
+// snapshots. mutators serialize a record and drop it into an in-memory
+// buffer; a dedicated flush thread writes and fsyncs the accumulated
+// batch every few milliseconds (group commit), so the RPC hot path
+// never blocks on disk. replay at startup merges the journal over the
+// snapshot using record timestamps, so a stale journal never regresses
+// newer state
+class ChangeJournal {
+public:
+    // default milliseconds between group-commit flushes
+    static constexpr int kDefaultFlushIntervalMs = 25;
+
+    explicit ChangeJournal(const std::string& path);
+    ~ChangeJournal();
+
+    // applies the journal on top of current state; returns records applied
+    size_t Replay(DeviceManager* device_manager);
+
+    // opens the journal for append and starts the flush thread
+    bool Start(int flush_interval_ms = kDefaultFlushIntervalMs);
+
+    // flushes outstanding records and stops the flush thread
+    void Stop();
+
+    // moves everything journaled so far into the rotated segment and
+    // starts the live segment fresh; called when a snapshot export
+    // begins so mutations landing during the export stay journaled
+    void Rotate();
+
+    // deletes the rotated segment; called only after the snapshot
+    // rename has succeeded and made the pre-export records redundant
+    void DropRotated();
+
+    // record appenders, called by DeviceManager after a successful mutation;
+    // timestamps are seconds since epoch
+    void AppendRegister(const std::string& device_id, const std::string& device_name,
+                        const std::string& device_type, int32_t status, int64_t timestamp);
+    void AppendStatus(const std::string& device_id, int32_t status, int64_t timestamp);
+    void AppendSetAction(const std::string& device_id, const std::string& action_id,
+                         int64_t timestamp);
+    void AppendClearAction(const std::string& device_id, int64_t timestamp);
+
+private:
+    void Append(const std::string& record);
+
+    void FlushLoop(int flush_interval_ms);
+
+    // writes and fsyncs everything buffered so far
+    void FlushPending();
+    void FlushPendingLocked();
+
+    // replays one segment file; returns records applied
+    size_t ReplayFile(const std::string& path, DeviceManager* device_manager);
+
+    std::string path_;
+    std::string rotated_path_;
+    int fd_;
+
+    // serializes file writes against rotation so Rotate never loses a
+    // batch flushed between reading the live segment and truncating it
+    std::mutex io_mutex_;
+
+    // group-commit buffer: appenders push here, the flush thread swaps
+    // it out and writes the whole batch with one write + fsync
+    std::string pending_;
+    std::mutex pending_mutex_;
+
+    std::thread flush_thread_;
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    std::atomic<bool> stop_requested_;
+};
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "metrics.h"
+#include <sstream>
+
+namespace device_management {
+
+ServerMetrics::ServerMetrics()
+    : start_time_(std::chrono::steady_clock::now()) {
+}
+
+void ServerMetrics::RecordRpc(RpcId rpc, uint64_t latency_usec) {
+    RpcMetric& metric = rpcs_[rpc];
+
+    size_t bucket = 0;
+    while (bucket + 1 < kLatencyBucketCount && (1ull << bucket) <= latency_usec) {
+        bucket++;
+    }
+
+    metric.count.fetch_add(1, std::memory_order_relaxed);
+    metric.total_usec.fetch_add(latency_usec, std::memory_order_relaxed);
+    metric.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+const char* ServerMetrics::RpcName(RpcId rpc) {
+    switch (rpc) {
+        case kRegisterDevice:             return "RegisterDevice";
+        case kRegisterDevices:            return "RegisterDevices";
+        case kSetDeviceStatus:            return "SetDeviceStatus";
+        case kSetDeviceStatusBatch:       return "SetDeviceStatusBatch";
+        case kGetDeviceInfo:              return "GetDeviceInfo";
+        case kInitiateDeviceAction:       return "InitiateDeviceAction";
+        case kInitiateDeviceActionBatch:  return "InitiateDeviceActionBatch";
+        case kGetDeviceActionStatus:      return "GetDeviceActionStatus";
+        case kGetDeviceActionHistory:     return "GetDeviceActionHistory";
+        case kCancelDeviceAction:         return "CancelDeviceAction";
+        case kListDevices:                return "ListDevices";
+        case kQueryDevices:               return "QueryDevices";
+        case kStreamDevices:              return "StreamDevices";
+        case kWatchDevices:               return "WatchDevices";
+        case kGetServerStats:             return "GetServerStats";
+        case kGetFleetStats:              return "GetFleetStats";
+        case kStartCampaign:              return "StartCampaign";
+        case kGetCampaignStatus:          return "GetCampaignStatus";
+        case kCreateDeviceGroup:          return "CreateDeviceGroup";
+        case kAssignDeviceToGroup:        return "AssignDeviceToGroup";
+        case kSetGroupStatus:             return "SetGroupStatus";
+        case kListGroupDevices:           return "ListGroupDevices";
+        case kInitiateGroupAction:        return "InitiateGroupAction";
+        case kExportFleet:                return "ExportFleet";
+        case kImportFleet:                return "ImportFleet";
+        default:                          return "Unknown";
+    }
+}
+
+std::vector<ServerMetrics::RpcSnapshot> ServerMetrics::Snapshot() const {
+    std::vector<RpcSnapshot> snapshots;
+    snapshots.reserve(kRpcCount);
+
+    for (size_t i = 0; i < kRpcCount; ++i) {
+        const RpcMetric& metric = rpcs_[i];
+
+        RpcSnapshot snapshot;
+        snapshot.name = RpcName(static_cast<RpcId>(i));
+        snapshot.count = metric.count.load(std::memory_order_relaxed);
+        snapshot.total_usec = metric.total_usec.load(std::memory_order_relaxed);
+        snapshot.buckets.reserve(kLatencyBucketCount);
+        for (const auto& bucket : metric.buckets) {
+            snapshot.buckets.push_back(bucket.load(std::memory_order_relaxed));
+        }
+        snapshots.push_back(std::move(snapshot));
+    }
+
+    return snapshots;
+}
+
+uint64_t ServerMetrics::ApproxPercentile(const std::vector<uint64_t>& buckets,
+                                         uint64_t total, double percentile) {
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t target = static_cast<uint64_t>(total * percentile);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen > target) {
+            // report the bucket's upper bound in microseconds
+            return 1ull << i;
+        }
+    }
+    return 1ull << (buckets.size() - 1);
+}
+
+std::string ServerMetrics::SummaryString() const {
+    std::ostringstream oss;
+    oss << "[stats] uptime=" << UptimeSeconds() << "s\n";
+
+    for (const auto& snapshot : Snapshot()) {
+        if (snapshot.count == 0) {
+            continue;
+        }
+        uint64_t avg = snapshot.total_usec / snapshot.count;
+        oss << "[stats] " << snapshot.name
+            << " count=" << snapshot.count
+            << " avg_usec=" << avg
+            << " p50_usec<=" << ApproxPercentile(snapshot.buckets, snapshot.count, 0.50)
+            << " p99_usec<=" << ApproxPercentile(snapshot.buckets, snapshot.count, 0.99)
+            << "\n";
+    }
+
+    return oss.str();
+}
+
+int64_t ServerMetrics::UptimeSeconds() const {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - start_time_).count();
+}
+
+}
@@ -0,0 +1,107 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace device_management {
+
+class ServerMetrics {
+public:
+    // one slot per RPC exposed by DeviceManagementService
+    enum RpcId {
+        kRegisterDevice = 0,
+        kRegisterDevices,
+        kSetDeviceStatus,
+        kSetDeviceStatusBatch,
+        kGetDeviceInfo,
+        kInitiateDeviceAction,
+        kInitiateDeviceActionBatch,
+        kGetDeviceActionStatus,
+        kGetDeviceActionHistory,
+        kCancelDeviceAction,
+        kListDevices,
+        kQueryDevices,
+        kStreamDevices,
+        kWatchDevices,
+        kGetServerStats,
+        kGetFleetStats,
+        kStartCampaign,
+        kGetCampaignStatus,
+        kCreateDeviceGroup,
+        kAssignDeviceToGroup,
+        kSetGroupStatus,
+        kListGroupDevices,
+        kInitiateGroupAction,
+        kExportFleet,
+        kImportFleet,
+        kRpcCount
+    };
+
+    // power-of-two microsecond buckets: [0,1), [1,2), [2,4), ... with the
+    // last bucket catching everything slower
+    static constexpr size_t kLatencyBucketCount = 24;
+
+    // aggregates per-RPC call counts and latency histograms; recording is
+    // a handful of relaxed atomic increments so the hot path stays cheap
+    ServerMetrics();
+
+    void RecordRpc(RpcId rpc, uint64_t latency_usec);
+
+    static const char* RpcName(RpcId rpc);
+
+    // point-in-time copy of one RPC's counters
+    struct RpcSnapshot {
+        std::string name;
+        uint64_t count;
+        uint64_t total_usec;
+        std::vector<uint64_t> buckets;
+    };
+
+    std::vector<RpcSnapshot> Snapshot() const;
+
+    // human-readable one-line-per-RPC summary for the periodic dump
+    std::string SummaryString() const;
+
+    int64_t UptimeSeconds() const;
+
+private:
+    struct RpcMetric {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> total_usec{0};
+        std::array<std::atomic<uint64_t>, kLatencyBucketCount> buckets{};
+    };
+
+    static uint64_t ApproxPercentile(const std::vector<uint64_t>& buckets,
+                                     uint64_t total, double percentile);
+
+    std::array<RpcMetric, kRpcCount> rpcs_;
+    std::chrono::steady_clock::time_point start_time_;
+};
+
+// records the latency of the enclosing scope into ServerMetrics on exit
+class ScopedRpcTimer {
+public:
+    ScopedRpcTimer(ServerMetrics& metrics, ServerMetrics::RpcId rpc)
+        : metrics_(metrics), rpc_(rpc), start_(std::chrono::steady_clock::now()) {
+    }
+
+    ~ScopedRpcTimer() {
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+        metrics_.RecordRpc(rpc_, static_cast<uint64_t>(elapsed));
+    }
+
+private:
+    ServerMetrics& metrics_;
+    ServerMetrics::RpcId rpc_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+}
+
+#endif
@@ -1,11 +1,17 @@
 #include <iostream>
 #include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
 #include <signal.h>
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/health_check_service_interface.h>
 #include <grpcpp/ext/proto_server_reflection_plugin.h>
 
+#include "coarse_clock.h"
 #include "device_management_service_impl.h"
+#include "snapshot_store.h"
+#include "journal.h"
 
 using grpc::Server;
 using grpc::ServerBuilder;
@@ -23,7 +29,7 @@ void SignalHandler(int signal) { //Used to handle the signal and shutdown the se
 
 int ParsePort(int argc, char** argv) {  //Used to extract the port from the command line arguments
     int port = 50051;
-    
+
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--port" && i + 1 < argc) {
@@ -31,25 +37,212 @@ int ParsePort(int argc, char** argv) {  //Used to extract the port from the comm
             break;
         }
     }
-    
+
     return port;
 }
 
+int ParseThreads(int argc, char** argv) {  //Size of the server's handler thread pool; 0 = one per core
+    int threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::stoi(argv[i + 1]);
+            break;
+        }
+    }
+
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (threads <= 0) {
+            threads = 4;
+        }
+    }
+
+    return threads;
+}
+
+int ParseStatsInterval(int argc, char** argv) {  //Seconds between stats dumps; 0 disables them
+    int interval = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stats-interval" && i + 1 < argc) {
+            interval = std::stoi(argv[i + 1]);
+            break;
+        }
+    }
+
+    return interval;
+}
+
+std::string ParseSnapshotPath(int argc, char** argv) {  //Snapshot file location; empty disables persistence
+    std::string path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--snapshot-path" && i + 1 < argc) {
+            path = argv[i + 1];
+            break;
+        }
+    }
+
+    return path;
+}
+
+int ParseSnapshotInterval(int argc, char** argv) {  //Seconds between snapshots
+    int interval = device_management::SnapshotStore::kDefaultSnapshotIntervalSeconds;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--snapshot-interval" && i + 1 < argc) {
+            interval = std::stoi(argv[i + 1]);
+            break;
+        }
+    }
+
+    return interval;
+}
+
+int ParseLivenessTtl(int argc, char** argv) {  //Seconds before a silent device goes OFFLINE; 0 disables
+    int ttl = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--liveness-ttl" && i + 1 < argc) {
+            ttl = std::stoi(argv[i + 1]);
+            break;
+        }
+    }
+
+    return ttl;
+}
+
+int ParseClockGranularity(int argc, char** argv) {  //Milliseconds between coarse clock refreshes
+    int granularity = device_management::CoarseClock::kDefaultGranularityMs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--clock-granularity-ms" && i + 1 < argc) {
+            granularity = std::stoi(argv[i + 1]);
+            break;
+        }
+    }
+
+    return granularity;
+}
+
+int ParseListInflightLimit(int argc, char** argv) {  //Concurrent listings before shedding; 0 disables
+    int limit = static_cast<int>(DeviceManagementServiceImpl::kDefaultListInflightLimit);
 
-void RunServer(int port) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--list-inflight-limit" && i + 1 < argc) {
+            limit = std::stoi(argv[i + 1]);
+            break;
+        }
+    }
+
+    if (limit < 0) {
+        limit = 0;
+    }
+
+    return limit;
+}
+
+std::string ParseJournalPath(int argc, char** argv) {  //Change journal location; empty disables journaling
+    std::string path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--journal-path" && i + 1 < argc) {
+            path = argv[i + 1];
+            break;
+        }
+    }
+
+    return path;
+}
+
+
+void RunServer(int port, int threads, int stats_interval, const std::string& snapshot_path,
+               int snapshot_interval, const std::string& journal_path, int liveness_ttl,
+               int list_inflight_limit) {
     std::string server_address = "0.0.0.0:" + std::to_string(port);
-    
+
     DeviceManagementServiceImpl service;
-    
+    service.SetListInflightLimit(static_cast<size_t>(list_inflight_limit));
+
+    // every WatchDevices stream parks a handler thread for its lifetime;
+    // capping watchers at half the pool keeps the rest free for unary
+    // traffic no matter how many clients subscribe
+    size_t watch_limit = threads > 1 ? static_cast<size_t>(threads) / 2 : 1;
+    service.SetWatchInflightLimit(watch_limit);
+
+    // restore the registry from the snapshot before the port opens, so a
+    // restarted server answers for the whole fleet immediately instead of
+    // riding out a re-registration storm
+    std::unique_ptr<device_management::SnapshotStore> snapshot_store;
+    if (!snapshot_path.empty()) {
+        snapshot_store = std::make_unique<device_management::SnapshotStore>(
+            service.device_manager(), snapshot_path);
+        size_t restored = snapshot_store->Load();
+        std::cout << "Restored " << restored << " device(s) from snapshot " << snapshot_path << "\n";
+    }
+
+    // the journal covers the interval since the last snapshot: replay it
+    // over the restored state, then attach it so new mutations are logged
+    std::unique_ptr<device_management::ChangeJournal> journal;
+    if (!journal_path.empty()) {
+        journal = std::make_unique<device_management::ChangeJournal>(journal_path);
+        size_t replayed = journal->Replay(service.device_manager());
+        std::cout << "Replayed " << replayed << " journal record(s) from " << journal_path << "\n";
+        if (journal->Start()) {
+            service.device_manager()->AttachJournal(journal.get());
+        }
+    }
+
+    if (snapshot_store) {
+        if (journal) {
+            // rotation at export start plus the drop after the rename
+            // means a mutation racing the save is always covered by the
+            // snapshot, the live segment, or the rotated one
+            snapshot_store->SetOnSnapshotBegin([&journal]() { journal->Rotate(); });
+            snapshot_store->SetOnSnapshot([&journal]() { journal->DropRotated(); });
+        }
+        snapshot_store->Start(snapshot_interval);
+    }
+
+    // ages out devices that stop heartbeating, replacing the external
+    // ListDevices+SetDeviceStatus sweeper
+    if (liveness_ttl > 0) {
+        service.device_manager()->StartLivenessMonitor(liveness_ttl);
+        std::cout << "Liveness monitor running with " << liveness_ttl << "s TTL\n";
+    }
+
     grpc::EnableDefaultHealthCheckService(true);
     grpc::reflection::InitProtoReflectionServerBuilderPlugin();
     
     ServerBuilder builder;
-    
+
+    // bound the handler pool explicitly instead of letting the sync server
+    // spawn a thread per in-flight call: the resource quota caps how many
+    // threads gRPC may create, and the poller options pin the completion
+    // queues to a fixed pool sized for the machine, so throughput scales
+    // with cores rather than with the thread-spawn rate. the small margin
+    // above the requested count covers gRPC's internal timer/resolver
+    // threads so they never starve the handler pool
+    grpc::ResourceQuota quota("device_management_server");
+    quota.SetMaxThreads(threads + 4);
+    builder.SetResourceQuota(quota);
+    builder.SetSyncServerOption(ServerBuilder::SyncServerOption::NUM_CQS, 1);
+    builder.SetSyncServerOption(ServerBuilder::SyncServerOption::MIN_POLLERS, 1);
+    builder.SetSyncServerOption(ServerBuilder::SyncServerOption::MAX_POLLERS, threads);
+
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
-    
+
     builder.RegisterService(&service);
-    
+
     std::unique_ptr<Server> server(builder.BuildAndStart());
     g_server = server.get();
     
@@ -57,21 +250,66 @@ void RunServer(int port) {
     std::cout << "Device Fleet Management Service\n";
     std::cout << "========================================\n";
     std::cout << "Server listening on " << server_address << "\n";
+    std::cout << "Handler threads: " << threads << "\n";
+    if (list_inflight_limit > 0) {
+        std::cout << "List shedding limit: " << list_inflight_limit << " in-flight\n";
+    }
+    std::cout << "Watch stream limit: " << watch_limit << " concurrent\n";
     std::cout << "Press Ctrl+C to shutdown\n";
     std::cout << "========================================\n";
     
     signal(SIGINT, SignalHandler);
     signal(SIGTERM, SignalHandler);
-    
+
+    // optional periodic dump of RPC counters and latency percentiles
+    std::atomic<bool> stats_running(true);
+    std::thread stats_thread;
+    if (stats_interval > 0) {
+        stats_thread = std::thread([&service, &stats_running, stats_interval]() {
+            while (stats_running) {
+                std::this_thread::sleep_for(std::chrono::seconds(stats_interval));
+                if (stats_running) {
+                    std::cout << service.metrics().SummaryString();
+                }
+            }
+        });
+    }
+
     server->Wait();
-    
+
+    stats_running = false;
+    if (stats_thread.joinable()) {
+        stats_thread.join();
+    }
+
+    if (liveness_ttl > 0) {
+        service.device_manager()->StopLivenessMonitor();
+    }
+    if (snapshot_store) {
+        snapshot_store->Stop();
+    }
+    if (journal) {
+        service.device_manager()->AttachJournal(nullptr);
+        journal->Stop();
+    }
+
     std::cout << "Server shutdown complete.\n";
 }
 
 int main(int argc, char** argv) {
     try {
         int port = ParsePort(argc, argv);
-        RunServer(port);
+        int threads = ParseThreads(argc, argv);
+        int stats_interval = ParseStatsInterval(argc, argv);
+        std::string snapshot_path = ParseSnapshotPath(argc, argv);
+        int snapshot_interval = ParseSnapshotInterval(argc, argv);
+        std::string journal_path = ParseJournalPath(argc, argv);
+        int liveness_ttl = ParseLivenessTtl(argc, argv);
+        int list_inflight_limit = ParseListInflightLimit(argc, argv);
+        device_management::CoarseClock::SetGranularity(
+            std::chrono::milliseconds(ParseClockGranularity(argc, argv)));
+        RunServer(port, threads, stats_interval, snapshot_path, snapshot_interval, journal_path,
+                  liveness_ttl, list_inflight_limit);
         return 0;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
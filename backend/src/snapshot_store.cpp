@@ -0,0 +1,244 @@
+#include "snapshot_store.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace device_management {
+
+// snapshot file layout: a fixed header followed by device_count records,
+// each record being three length-prefixed strings (id, name, type), the
+// status as int32, and two int64 second timestamps
+namespace {
+
+constexpr uint32_t kSnapshotMagic = 0x44464d53;  // "DFMS"
+constexpr uint32_t kSnapshotVersion = 1;
+
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t device_count;
+};
+
+void AppendBytes(std::string& out, const void* data, size_t size) {
+    out.append(static_cast<const char*>(data), size);
+}
+
+void AppendString(std::string& out, const std::string& value) {
+    uint32_t length = static_cast<uint32_t>(value.size());
+    AppendBytes(out, &length, sizeof(length));
+    AppendBytes(out, value.data(), value.size());
+}
+
+// reads size bytes from the mapped region, advancing the cursor;
+// returns false when the snapshot is truncated
+bool ReadBytes(const char*& cursor, const char* end, void* out, size_t size) {
+    if (static_cast<size_t>(end - cursor) < size) {
+        return false;
+    }
+    std::memcpy(out, cursor, size);
+    cursor += size;
+    return true;
+}
+
+bool ReadString(const char*& cursor, const char* end, std::string* out) {
+    uint32_t length = 0;
+    if (!ReadBytes(cursor, end, &length, sizeof(length))) {
+        return false;
+    }
+    if (static_cast<size_t>(end - cursor) < length) {
+        return false;
+    }
+    out->assign(cursor, length);
+    cursor += length;
+    return true;
+}
+
+}
+
+SnapshotStore::SnapshotStore(DeviceManager* device_manager, const std::string& path)
+    : device_manager_(device_manager), path_(path), stop_requested_(false) {
+}
+
+SnapshotStore::~SnapshotStore() {
+    Stop();
+}
+
+size_t SnapshotStore::Load() {
+    int fd = open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+        close(fd);
+        return 0;
+    }
+
+    size_t file_size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return 0;
+    }
+
+    const char* cursor = static_cast<const char*>(mapped);
+    const char* end = cursor + file_size;
+
+    SnapshotHeader header;
+    size_t restored = 0;
+
+    if (ReadBytes(cursor, end, &header, sizeof(header)) &&
+        header.magic == kSnapshotMagic && header.version == kSnapshotVersion) {
+
+        // the header count is untrusted input: a corrupt value must not
+        // drive reserve() into bad_alloc and abort startup, so clamp it
+        // to what the file could possibly hold (empty strings make the
+        // smallest record 32 bytes: three u32 length prefixes, the i32
+        // status, and two i64 timestamps)
+        constexpr uint64_t kMinRecordBytes = 32;
+        uint64_t max_records = (file_size - sizeof(SnapshotHeader)) / kMinRecordBytes;
+        uint64_t device_count = std::min(header.device_count, max_records);
+
+        std::vector<DeviceManager::DeviceRecord> records;
+        records.reserve(device_count);
+
+        for (uint64_t i = 0; i < device_count; ++i) {
+            DeviceManager::DeviceRecord record;
+            int32_t status = 0;
+
+            if (!ReadString(cursor, end, &record.device_id) ||
+                !ReadString(cursor, end, &record.device_name) ||
+                !ReadString(cursor, end, &record.device_type) ||
+                !ReadBytes(cursor, end, &status, sizeof(status)) ||
+                !ReadBytes(cursor, end, &record.registered_at, sizeof(record.registered_at)) ||
+                !ReadBytes(cursor, end, &record.last_updated, sizeof(record.last_updated))) {
+                // truncated snapshot: keep what parsed cleanly so far
+                break;
+            }
+
+            // a corrupt or tampered snapshot must not feed an arbitrary
+            // int into the per-status counter array
+            if (!DeviceStatus_IsValid(status)) {
+                continue;
+            }
+
+            record.status = static_cast<DeviceStatus>(status);
+            records.push_back(std::move(record));
+        }
+
+        restored = records.size();
+        device_manager_->RestoreDevices(records);
+    }
+
+    munmap(mapped, file_size);
+    return restored;
+}
+
+bool SnapshotStore::Save() {
+    // the journal rotates before the shard-by-shard export so any
+    // mutation racing the export survives in one segment or the other
+    if (on_snapshot_begin_) {
+        on_snapshot_begin_();
+    }
+
+    std::vector<DeviceManager::DeviceRecord> records = device_manager_->ExportDevices();
+
+    std::string buffer;
+    buffer.reserve(sizeof(SnapshotHeader) + records.size() * 64);
+
+    SnapshotHeader header;
+    header.magic = kSnapshotMagic;
+    header.version = kSnapshotVersion;
+    header.device_count = records.size();
+    AppendBytes(buffer, &header, sizeof(header));
+
+    for (const auto& record : records) {
+        AppendString(buffer, record.device_id);
+        AppendString(buffer, record.device_name);
+        AppendString(buffer, record.device_type);
+        int32_t status = static_cast<int32_t>(record.status);
+        AppendBytes(buffer, &status, sizeof(status));
+        AppendBytes(buffer, &record.registered_at, sizeof(record.registered_at));
+        AppendBytes(buffer, &record.last_updated, sizeof(record.last_updated));
+    }
+
+    // write to a temp file and rename so a crash never leaves a torn snapshot
+    std::string temp_path = path_ + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(buffer.data(), buffer.size());
+        if (!out) {
+            return false;
+        }
+    }
+
+    if (std::rename(temp_path.c_str(), path_.c_str()) != 0) {
+        return false;
+    }
+
+    if (on_snapshot_) {
+        on_snapshot_();
+    }
+    return true;
+}
+
+void SnapshotStore::SetOnSnapshotBegin(std::function<void()> callback) {
+    on_snapshot_begin_ = std::move(callback);
+}
+
+void SnapshotStore::SetOnSnapshot(std::function<void()> callback) {
+    on_snapshot_ = std::move(callback);
+}
+
+void SnapshotStore::Start(int interval_seconds) {
+    if (interval_seconds <= 0 || snapshot_thread_.joinable()) {
+        return;
+    }
+    snapshot_thread_ = std::thread([this, interval_seconds]() {
+        SnapshotLoop(interval_seconds);
+    });
+}
+
+void SnapshotStore::Stop() {
+    if (!snapshot_thread_.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stop_requested_ = true;
+    }
+    stop_cv_.notify_all();
+    snapshot_thread_.join();
+
+    // final snapshot so a clean shutdown never loses registrations
+    Save();
+}
+
+void SnapshotStore::SnapshotLoop(int interval_seconds) {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    while (!stop_requested_) {
+        if (stop_cv_.wait_for(lock, std::chrono::seconds(interval_seconds),
+                              [this]() { return stop_requested_.load(); })) {
+            break;
+        }
+        lock.unlock();
+        Save();
+        lock.lock();
+    }
+}
+
+}
@@ -0,0 +1,66 @@
+#ifndef SNAPSHOT_STORE_H
+#define SNAPSHOT_STORE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "device_manager.h"
+
+namespace device_management {
+
+// persists the device registry to a compact binary snapshot file and
+// restores it at startup. loading memory-maps the file and parses the
+// records in place, so a large registry is available in milliseconds
+// before the server starts listening
+class SnapshotStore {
+public:
+    // default seconds between background snapshots
+    static constexpr int kDefaultSnapshotIntervalSeconds = 60;
+
+    SnapshotStore(DeviceManager* device_manager, const std::string& path);
+    ~SnapshotStore();
+
+    // loads the snapshot file if it exists; returns the number of devices
+    // restored, or 0 when there is no usable snapshot
+    size_t Load();
+
+    // writes one snapshot now; the file is written to a temp name and
+    // renamed so readers never observe a partial snapshot
+    bool Save();
+
+    // starts the periodic snapshot thread
+    void Start(int interval_seconds = kDefaultSnapshotIntervalSeconds);
+
+    // takes a final snapshot and stops the background thread
+    void Stop();
+
+    // invoked just before the registry export starts; used to rotate the
+    // change journal so mutations landing in already-exported shards
+    // during the save are not lost with the pre-export records
+    void SetOnSnapshotBegin(std::function<void()> callback);
+
+    // invoked after every successful save; used to drop the rotated
+    // journal segment once a snapshot has made it redundant
+    void SetOnSnapshot(std::function<void()> callback);
+
+private:
+    void SnapshotLoop(int interval_seconds);
+
+    DeviceManager* device_manager_;
+    std::string path_;
+    std::function<void()> on_snapshot_begin_;
+    std::function<void()> on_snapshot_;
+
+    std::thread snapshot_thread_;
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    std::atomic<bool> stop_requested_;
+};
+
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace device_management {
+
+// interns strings that repeat across many devices (device_type holds a
+// handful of distinct values fleet-wide), so each value is heap-allocated
+// once instead of per device. unordered_set nodes give the returned
+// pointers stable addresses across rehashes; interned strings live for
+// the pool's lifetime, which matches the owning DeviceManager
+class StringPool {
+public:
+    const std::string* Intern(const std::string& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return &*pool_.insert(value).first;
+    }
+
+private:
+    std::unordered_set<std::string> pool_;
+    std::mutex mutex_;
+};
+
+}
+
+#endif